@@ -10,22 +10,38 @@ layout (std140, binding = ##UNIFORM_CAMERA_DATA_BINDING) uniform UniformCameraDa
 	mat4 u_OrthoProjection;
 };
 
-uniform vec3 u_ChunkPosition;
+layout (std430, binding = ##STORAGE_CHUNK_POSITIONS_BINDING) readonly buffer StorageChunkPositions
+{
+	vec4 s_ChunkPositions[];
+};
 
 out flat uint v_TexIndex;
-out vec2 v_TexCoord;
+out flat uint v_TexFace;
+out vec2 v_TileCoord;
 out vec3 v_Normal;
 
-const float uvWidth  = 1.0 / 6.0;
-const float uvHeight = 1.0;
+// Corners of a single texture tile, multiplied by the quad size so the texture repeats once per block
+const vec2 tileCorners[4] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
+
+// Directions in which quad width and height grow for every face
+const vec3 blockFaceWidthAxes[6] = vec3[](
+    vec3(1.0, 0.0, 0.0), // Front
+    vec3(0.0, 0.0, 1.0), // Left
+    vec3(1.0, 0.0, 0.0), // Back
+    vec3(0.0, 0.0, 1.0), // Right
+    vec3(1.0, 0.0, 0.0), // Top
+    vec3(1.0, 0.0, 0.0)  // Bottom
+);
 
-const vec2 blockFaceUV[6][4] = vec2[6][4](
-    vec2[](vec2(0.0,           0.0), vec2(uvWidth,       0.0), vec2(uvWidth,       uvHeight), vec2(0.0,           uvHeight)), // Front
-    vec2[](vec2(uvWidth,       0.0), vec2(2.0 * uvWidth, 0.0), vec2(2.0 * uvWidth, uvHeight), vec2(uvWidth,       uvHeight)), // Left
-    vec2[](vec2(2.0 * uvWidth, 0.0), vec2(3.0 * uvWidth, 0.0), vec2(3.0 * uvWidth, uvHeight), vec2(2.0 * uvWidth, uvHeight)), // Back
-    vec2[](vec2(3.0 * uvWidth, 0.0), vec2(4.0 * uvWidth, 0.0), vec2(4.0 * uvWidth, uvHeight), vec2(3.0 * uvWidth, uvHeight)), // Right
-    vec2[](vec2(4.0 * uvWidth, 0.0), vec2(5.0 * uvWidth, 0.0), vec2(5.0 * uvWidth, uvHeight), vec2(4.0 * uvWidth, uvHeight)), // Top
-    vec2[](vec2(5.0 * uvWidth, 0.0), vec2(6.0 * uvWidth, 0.0), vec2(6.0 * uvWidth, uvHeight), vec2(5.0 * uvWidth, uvHeight))  // Bottom
+const vec3 blockFaceHeightAxes[6] = vec3[](
+    vec3(0.0, 1.0, 0.0), // Front
+    vec3(0.0, 1.0, 0.0), // Left
+    vec3(0.0, 1.0, 0.0), // Back
+    vec3(0.0, 1.0, 0.0), // Right
+    vec3(0.0, 0.0, 1.0), // Top
+    vec3(0.0, 0.0, 1.0)  // Bottom
 );
 
 const vec3 blockFaceNormals[6] = vec3[]( 
@@ -55,20 +71,42 @@ void main()
     uint tex  = (a_PackedData1 >> 19) & 0x1FF;
     uint ind  = (a_PackedData1 >> 28) & 0x03;
     uint rot  = (a_PackedData1 >> 30) & 0x03; 
+    uint width  = ((a_PackedData2     ) & 0xFF) + 1;
+    uint height = ((a_PackedData2 >> 8) & 0xFF) + 1;
 
-    vec3 position = vec3(posX, posY, posZ) + u_ChunkPosition;
+    vec3 position = vec3(posX, posY, posZ) + s_ChunkPositions[gl_DrawID].xyz;
 
+    // Corners on the far side of the quad are moved by its size
+    vec3 corner  = blockFacePositions[face][ind];
+    vec3 stretch = blockFaceWidthAxes[face] * float(width - 1) + blockFaceHeightAxes[face] * float(height - 1);
+    position += corner + (corner + 0.5) * stretch;
+
+    vec2 tileSize = vec2(width, height);
     if (face == 4) 
-        v_TexCoord = blockFaceUV[face][(ind - rot + 4) % 4];
+    {
+        v_TileCoord = tileCorners[(ind - rot + 4) % 4];
+        v_TexFace   = face;
+        if (rot % 2 == 1)
+            tileSize = tileSize.yx;
+    }
     else if (face == 5)
-        v_TexCoord = blockFaceUV[face][(ind + rot) % 4];
+    {
+        v_TileCoord = tileCorners[(ind + rot) % 4];
+        v_TexFace   = face;
+        if (rot % 2 == 1)
+            tileSize = tileSize.yx;
+    }
     else 
-        v_TexCoord = blockFaceUV[(face + rot) % 4][ind];
-
-    v_Normal   = blockFaceNormals[face];
-    v_TexIndex = tex;
+    {
+        v_TileCoord = tileCorners[ind];
+        v_TexFace   = (face + rot) % 4;
+    }
+
+    v_TileCoord *= tileSize;
+    v_Normal     = blockFaceNormals[face];
+    v_TexIndex   = tex;
  
-    gl_Position = u_ViewProjection * vec4(position + blockFacePositions[face][ind], 1.0);
+    gl_Position = u_ViewProjection * vec4(position, 1.0);
 }
 
 ### FRAGMENT
@@ -79,12 +117,21 @@ layout (location = 0) out vec4 o_Color;
 uniform sampler2DArray u_Textures;
 
 in flat uint v_TexIndex;
-in vec2 v_TexCoord;
+in flat uint v_TexFace;
+in vec2 v_TileCoord;
 in vec3 v_Normal;
 
+// Every texture layer holds 6 faces next to each other
+const float uvWidth  = 1.0 / 6.0;
+const float uvHeight = 1.0;
+
 void main()
 {
-    vec4 color = texture(u_Textures, vec3(v_TexCoord, v_TexIndex));
+    // Merged quads repeat the tile, gradients are taken before fract() so mipmaps do not break on tile edges
+    vec2 texCoord = vec2((float(v_TexFace) + fract(v_TileCoord.x)) * uvWidth, fract(v_TileCoord.y) * uvHeight);
+    vec2 scale    = vec2(uvWidth, uvHeight);
+
+    vec4 color = textureGrad(u_Textures, vec3(texCoord, v_TexIndex), dFdx(v_TileCoord) * scale, dFdy(v_TileCoord) * scale);
     if (color.a < 0.1)
         discard;
 
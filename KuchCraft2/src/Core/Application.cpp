@@ -11,6 +11,7 @@
 #include "Core/Input.h"
 #include "Core/Config.h"
 #include "Core/Random.h"
+#include "Core/ThreadPool.h"
 
 #include "Graphics/Renderer.h"
 
@@ -28,6 +29,7 @@ namespace KuchCraft {
 		ApplicationConfig::Init();
 		Log::Init();
 		RandomEngineInit();
+		ThreadPool::Init(ApplicationConfig::GetWorldData().WorkerThreads);
 
 		WindowData windowData;
 		windowData.Config = ApplicationConfig::GetWindowData();
@@ -62,6 +64,7 @@ namespace KuchCraft {
 
 	void Application::OnShutdown()
 	{
+		ThreadPool::Shutdown();
 		Renderer::Shutdown();
 		ApplicationConfig::Save();
 
@@ -0,0 +1,61 @@
+///
+/// @file ConcurrentQueue.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ConcurrentQueue class, a mutex protected queue
+///        handing results from worker threads back to the main thread.
+///
+/// @details Worker threads push finished values one by one, the main thread takes all of them at once
+///          with PopAll() every frame, so the lock is held only for a swap of two vectors.
+///
+/// @thread_safety Thread-safe, every method can be called from any thread.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	/// A simple mutex protected queue used to hand results from worker threads back to the main thread
+	template<typename T>
+	class ConcurrentQueue
+	{
+	public:
+		ConcurrentQueue() = default;
+
+		~ConcurrentQueue() = default;
+
+		/// Adds a value to the end of the queue
+		void Push(T value)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Data.push_back(std::move(value));
+		}
+
+		/// Moves all queued values to the output vector, in the order they were pushed.
+		/// The output vector is cleared first.
+		void PopAll(std::vector<T>& output)
+		{
+			output.clear();
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			std::swap(output, m_Data);
+		}
+
+		/// Checks if the queue is empty
+		[[nodiscard]] bool IsEmpty() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Data.empty();
+		}
+
+	private:
+		/// Queued values
+		std::vector<T> m_Data;
+
+		/// Protects queued values
+		mutable std::mutex m_Mutex;
+
+	};
+
+}
@@ -53,6 +53,7 @@ namespace KuchCraft {
 					rendererConfig.Renderer2DMaxQuads = json["Renderer"]["Renderer2DMaxQuads"].get<uint32_t>();
 					rendererConfig.Renderer3DMaxQuads = json["Renderer"]["Renderer3DMaxQuads"].get<uint32_t>();
 					rendererConfig.BlockTextureSize   = json["Renderer"]["BlockTextureSize"].get<uint32_t>();
+					rendererConfig.ChunkBufferSizeMB  = json["Renderer"]["ChunkBufferSizeMB"].get<uint32_t>();
 					for (const auto& [time, color]    : json["Renderer"]["SkyboxColor"].items())
 						rendererConfig.SkyboxColor[InGameTime::StringToTimeOfDay(time)] = { color[0], color[1], color[2], color[3] };
 					s_RendererConfig = rendererConfig;
@@ -60,15 +61,23 @@ namespace KuchCraft {
 					WorldConfigData worldConfig;
 					worldConfig.WorldsDirectory        = json["World"]["WorldsDirectory"].get<std::string>();
 					worldConfig.WorldDataFile          = json["World"]["WorldDataFile"].get<std::string>();
+					worldConfig.RegionDirectory        = json["World"]["RegionDirectory"].get<std::string>();
 					worldConfig.BiomePackFile          = json["World"]["BiomePackFile"].get<std::string>();
 					worldConfig.WorldGeneratorPackFile = json["World"]["WorldGeneratorPackFile"].get<std::string>();
 					worldConfig.TexturePackFile        = json["World"]["TexturePackFile"].get<std::string>();
 					worldConfig.TexturesDirectory      = json["World"]["TexturesDirectory"].get<std::string>();
 					worldConfig.RenderDistance         = json["World"]["RenderDistance"].get<uint32_t>();
 					worldConfig.KeptInMemoryDistance   = json["World"]["KeptInMemoryDistance"].get<uint32_t>();
-					worldConfig.ChunksToBuildInFrame   = json["World"]["ChunksToBuildInFrame"].get<uint32_t>();
-					worldConfig.ChuksToRecreateInFrame = json["World"]["ChuksToRecreateInFrame"].get<uint32_t>();
+					worldConfig.ChunkWorkBudgetMs      = json["World"]["ChunkWorkBudgetMs"].get<float>();
+					worldConfig.TargetFrameTimeMs      = json["World"]["TargetFrameTimeMs"].get<float>();
 					worldConfig.DurationOfDayInMinutes = json["World"]["DurationOfDayInMinutes"].get<uint32_t>();
+					worldConfig.WorkerThreads          = json["World"]["WorkerThreads"].get<uint32_t>();
+					worldConfig.GreedyMeshing          = json["World"]["GreedyMeshing"].get<bool>();
+					worldConfig.ChunkPoolHugePages     = json["World"]["ChunkPoolHugePages"].get<bool>();
+					worldConfig.GeneratorRegionSize    = json["World"]["GeneratorRegionSize"].get<uint32_t>();
+					worldConfig.ChunkDeltaPersistence  = json["World"]["ChunkDeltaPersistence"].get<bool>();
+					worldConfig.ChunkDeltaMaxBlocks    = json["World"]["ChunkDeltaMaxBlocks"].get<uint32_t>();
+					worldConfig.AutosaveIntervalSeconds = json["World"]["AutosaveIntervalSeconds"].get<uint32_t>();
 					s_WorldConfig = worldConfig;
 				}
 				catch (const std::exception& e)
@@ -118,7 +127,8 @@ namespace KuchCraft {
 			{ "ShaderVersion",      s_RendererConfig.ShaderVersion },
 			{ "Renderer2DMaxQuads", s_RendererConfig.Renderer2DMaxQuads },
 			{ "Renderer3DMaxQuads", s_RendererConfig.Renderer3DMaxQuads },
-			{ "BlockTextureSize",   s_RendererConfig.BlockTextureSize }
+			{ "BlockTextureSize",   s_RendererConfig.BlockTextureSize },
+			{ "ChunkBufferSizeMB",  s_RendererConfig.ChunkBufferSizeMB }
 		};
 
 		for (const auto& [time, color] : s_RendererConfig.SkyboxColor)
@@ -127,15 +137,23 @@ namespace KuchCraft {
 		json["World"] = {
 			{ "WorldsDirectory",        s_WorldConfig.WorldsDirectory },
 			{ "WorldDataFile",          s_WorldConfig.WorldDataFile },
+			{ "RegionDirectory",        s_WorldConfig.RegionDirectory },
 			{ "TexturePackFile",        s_WorldConfig.TexturePackFile },
 			{ "BiomePackFile",          s_WorldConfig.BiomePackFile },
 			{ "WorldGeneratorPackFile", s_WorldConfig.WorldGeneratorPackFile },
 			{ "TexturesDirectory",      s_WorldConfig.TexturesDirectory },
 			{ "RenderDistance",         s_WorldConfig.RenderDistance },
 			{ "KeptInMemoryDistance",   s_WorldConfig.KeptInMemoryDistance },
-			{ "ChunksToBuildInFrame",   s_WorldConfig.ChunksToBuildInFrame },
-			{ "ChuksToRecreateInFrame", s_WorldConfig.ChuksToRecreateInFrame },
-			{ "DurationOfDayInMinutes", s_WorldConfig.DurationOfDayInMinutes }
+			{ "ChunkWorkBudgetMs",      s_WorldConfig.ChunkWorkBudgetMs },
+			{ "TargetFrameTimeMs",      s_WorldConfig.TargetFrameTimeMs },
+			{ "DurationOfDayInMinutes", s_WorldConfig.DurationOfDayInMinutes },
+			{ "WorkerThreads",          s_WorldConfig.WorkerThreads },
+			{ "GreedyMeshing",          s_WorldConfig.GreedyMeshing },
+			{ "ChunkPoolHugePages",     s_WorldConfig.ChunkPoolHugePages },
+			{ "GeneratorRegionSize",    s_WorldConfig.GeneratorRegionSize },
+			{ "ChunkDeltaPersistence",  s_WorldConfig.ChunkDeltaPersistence },
+			{ "ChunkDeltaMaxBlocks",    s_WorldConfig.ChunkDeltaMaxBlocks },
+			{ "AutosaveIntervalSeconds", s_WorldConfig.AutosaveIntervalSeconds }
 		};
 
 		std::ofstream file(s_ConfigPath);
@@ -121,6 +121,9 @@ namespace KuchCraft {
         /// Size of texture block
         uint32_t BlockTextureSize = 16;
 
+        /// Size in megabytes of the shared vertex buffer holding all chunk meshes.
+        uint32_t ChunkBufferSizeMB = 128;
+
         /// Skybox colors for different times of day, represented as a map.
         /// The keys are time periods (Dawn, Morning, Noon, etc.), and values are RGBA colors.
         std::map<TimeOfDay, glm::vec4> SkyboxColor = {
@@ -143,6 +146,9 @@ namespace KuchCraft {
         /// Main world entities file
         std::string WorldDataFile = "world_data.kc";
 
+        /// Directory inside the world directory holding saved chunks
+        std::string RegionDirectory = "region";
+
         /// Item description info file
         std::string TexturePackFile = "itemInfo.kc";
 
@@ -161,14 +167,37 @@ namespace KuchCraft {
         /// Radius of maximum number of chunks to be kept in memory
         uint32_t KeptInMemoryDistance = 10;
 
-        /// Number of chunks to be build in single frame
-        uint32_t ChunksToBuildInFrame = 1;
+        /// Maximum time in milliseconds the main thread spends on chunk work in a single frame,
+        /// the budget is lowered automatically while frames are slower than TargetFrameTimeMs
+        float ChunkWorkBudgetMs = 4.0f;
 
-        /// Number of chunks to be recreated in single frame
-        uint32_t ChuksToRecreateInFrame = 1;
+        /// Frame time in milliseconds the chunk work budget adapts to
+        float TargetFrameTimeMs = 16.6f;
 
 		/// The duration of the day in minutes
         uint32_t DurationOfDayInMinutes = 20;
+
+        /// Number of worker threads used for chunk generation, 0 uses all hardware threads but one
+        uint32_t WorkerThreads = 0;
+
+        /// Whether chunk meshes merge neighboring faces with the same texture into larger quads
+        bool GreedyMeshing = true;
+
+        /// Number of chunks along a side of the square region the world generator evaluates noises for at once
+        uint32_t GeneratorRegionSize = 4;
+
+        /// Whether chunk pool slabs ask the system for huge pages, supported on Linux only
+        bool ChunkPoolHugePages = true;
+
+        /// Whether edited chunks store only the blocks that differ from the generated terrain,
+        /// otherwise every new or modified chunk is stored whole
+        bool ChunkDeltaPersistence = true;
+
+        /// Number of edited blocks above which a chunk stops tracking its edits and is stored whole
+        uint32_t ChunkDeltaMaxBlocks = 4096;
+
+        /// Time in seconds between automatic saves of the world in the background, 0 disables them
+        uint32_t AutosaveIntervalSeconds = 300;
     };
 
     class ApplicationConfig
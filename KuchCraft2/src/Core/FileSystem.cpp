@@ -0,0 +1,111 @@
+///
+/// @file FileSystem.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "Core/FileSystem.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace KuchCraft {
+
+	bool FileSystem::WriteAtomic(const std::filesystem::path& path, const void* data, size_t size)
+	{
+		std::filesystem::path temporary = path;
+		temporary += ".tmp";
+
+#ifdef _WIN32
+		HANDLE file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			Log::Error("[File System] : Failed to open : {}", temporary.string());
+			return false;
+		}
+
+		DWORD written = 0;
+		bool  valid   = WriteFile(file, data, (DWORD)size, &written, nullptr) && written == size && FlushFileBuffers(file);
+		CloseHandle(file);
+
+		/// MoveFileEx replaces the target in a single step, unlike removing it first
+		valid = valid && MoveFileExW(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+		int file = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (file < 0)
+		{
+			Log::Error("[File System] : Failed to open : {}", temporary.string());
+			return false;
+		}
+
+		const uint8_t* bytes   = static_cast<const uint8_t*>(data);
+		size_t         written = 0;
+		while (written < size)
+		{
+			ssize_t result = write(file, bytes + written, size - written);
+			if (result <= 0)
+				break;
+
+			written += (size_t)result;
+		}
+
+		bool valid = written == size && fsync(file) == 0;
+		close(file);
+
+		valid = valid && rename(temporary.c_str(), path.c_str()) == 0;
+
+		/// The rename itself is durable only once the directory is flushed
+		if (valid)
+		{
+			int directory = open(path.parent_path().empty() ? "." : path.parent_path().c_str(), O_RDONLY);
+			if (directory >= 0)
+			{
+				fsync(directory);
+				close(directory);
+			}
+		}
+#endif
+
+		if (!valid)
+		{
+			Log::Error("[File System] : Failed to write : {}", path.string());
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+		}
+
+		return valid;
+	}
+
+	bool FileSystem::Sync(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		bool valid = FlushFileBuffers(file);
+		CloseHandle(file);
+#else
+		/// Flushing through any descriptor writes back every dirty page of the file
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		bool valid = fsync(file) == 0;
+		close(file);
+#endif
+
+		if (!valid)
+			Log::Error("[File System] : Failed to flush : {}", path.string());
+
+		return valid;
+	}
+
+}
@@ -0,0 +1,37 @@
+///
+/// @file FileSystem.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the FileSystem class, which writes files
+///        so that they survive a crash or power loss.
+///
+/// @details WriteAtomic() writes a temporary file next to the target, flushes it to the disk and renames it
+///          over the target, so the file holds either its old or its new content, never a part of it.
+///          Sync() flushes data already written to a file through another handle.
+///
+/// @thread_safety Thread-safe, as long as the same file is not written by two threads at once.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class FileSystem
+	{
+	public:
+		/// Replaces the content of a file atomically.
+		/// @param path - the path of the file.
+		/// @param data - the new content.
+		/// @param size - the size of the content in bytes.
+		/// @return True if the file was replaced, otherwise it keeps its old content.
+		static bool WriteAtomic(const std::filesystem::path& path, const void* data, size_t size);
+
+		/// Flushes written data of a file from the system cache to the disk.
+		/// @param path - the path of the file.
+		/// @return True if the data reached the disk.
+		static bool Sync(const std::filesystem::path& path);
+
+	};
+
+}
@@ -0,0 +1,159 @@
+///
+/// @file MappedFile.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "Core/MappedFile.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace KuchCraft {
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::Open(const std::filesystem::path& path)
+	{
+		Close();
+
+		/// Other handles keep writing to the file, so writes have to be shared
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			Log::Error("[Mapped File] : Failed to open : {}", path.string());
+			return false;
+		}
+
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			Log::Error("[Mapped File] : Empty file : {}", path.string());
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void*  data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			Log::Error("[Mapped File] : Failed to map : {}", path.string());
+			if (mapping)
+				CloseHandle(mapping);
+
+			CloseHandle(file);
+			return false;
+		}
+
+		m_File    = file;
+		m_Mapping = mapping;
+		m_Data    = static_cast<const uint8_t*>(data);
+		m_Size    = (size_t)size.QuadPart;
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+
+		if (m_File)
+			CloseHandle(m_File);
+
+		m_Data    = nullptr;
+		m_Size    = 0;
+		m_Mapping = nullptr;
+		m_File    = nullptr;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (!m_Data || offset >= m_Size)
+			return;
+
+		WIN32_MEMORY_RANGE_ENTRY range = { const_cast<uint8_t*>(m_Data) + offset, std::min(size, m_Size - offset) };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+
+#else
+
+	bool MappedFile::Open(const std::filesystem::path& path)
+	{
+		Close();
+
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			Log::Error("[Mapped File] : Failed to open : {}", path.string());
+			return false;
+		}
+
+		struct stat status = {};
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			Log::Error("[Mapped File] : Empty file : {}", path.string());
+			close(file);
+			return false;
+		}
+
+		/// The mapping keeps its own reference to the file, the descriptor is not needed anymore
+		void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+		close(file);
+
+		if (data == MAP_FAILED)
+		{
+			Log::Error("[Mapped File] : Failed to map : {}", path.string());
+			return false;
+		}
+
+		madvise(data, (size_t)status.st_size, MADV_RANDOM);
+
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = (size_t)status.st_size;
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			munmap(const_cast<uint8_t*>(m_Data), m_Size);
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (!m_Data || offset >= m_Size)
+			return;
+
+		/// madvise needs a page aligned address
+		static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+
+		size_t begin = offset / pageSize * pageSize;
+		size_t end   = std::min(offset + size, m_Size);
+		madvise(const_cast<uint8_t*>(m_Data) + begin, end - begin, MADV_WILLNEED);
+	}
+
+#endif
+
+}
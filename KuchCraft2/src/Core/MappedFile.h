@@ -0,0 +1,65 @@
+///
+/// @file MappedFile.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the MappedFile class, a read-only
+///        memory mapping of a whole file.
+///
+/// @details The file is mapped with mmap on Linux and with a file mapping object on Windows.
+///          The mapping covers the file size at the time it was opened, data written past it later
+///          is visible only after the file is opened again. Automatic read-ahead is turned off
+///          where the system allows it, pages are read when touched or when Prefetch() asks for them.
+///
+/// @thread_safety Not thread-safe, concurrent reads of the mapped data are safe while nobody reopens the file.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// Maps a file, closing the previous mapping.
+		/// @param path - the path of the file.
+		/// @return True if the file was mapped.
+		bool Open(const std::filesystem::path& path);
+
+		/// Releases the mapping.
+		void Close();
+
+		/// Checks if a file is mapped.
+		inline [[nodiscard]] bool IsOpen() const { return m_Data != nullptr; }
+
+		/// Retrieves the mapped data.
+		inline [[nodiscard]] const uint8_t* GetData() const { return m_Data; }
+
+		/// Retrieves the number of mapped bytes.
+		inline [[nodiscard]] size_t GetSize() const { return m_Size; }
+
+		/// Asks the system to read a range of the file into memory in the background.
+		/// @param offset - the first byte of the range.
+		/// @param size - the size of the range in bytes, clamped to the mapped size.
+		void Prefetch(size_t offset, size_t size) const;
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t         m_Size = 0;
+
+#ifdef _WIN32
+		/// File and file mapping object handles.
+		void* m_File    = nullptr;
+		void* m_Mapping = nullptr;
+#endif
+
+	};
+
+}
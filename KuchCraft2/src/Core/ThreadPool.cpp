@@ -0,0 +1,103 @@
+///
+/// @file ThreadPool.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "Core/ThreadPool.h"
+
+#include "Core/Random.h"
+
+namespace KuchCraft {
+
+	void ThreadPool::Init(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		s_Running = true;
+		s_Workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			s_Workers.emplace_back(&ThreadPool::WorkerLoop);
+
+		Log::Info("[ThreadPool] : Started {} worker threads", threadCount);
+	}
+
+	void ThreadPool::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_Running = false;
+		}
+		s_TaskAvailable.notify_all();
+
+		for (auto& worker : s_Workers)
+			worker.join();
+
+		s_Workers.clear();
+	}
+
+	void ThreadPool::Submit(std::function<void()> task)
+	{
+		if (s_Workers.empty())
+		{
+			task();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_Tasks.push(std::move(task));
+			s_PendingTasks++;
+		}
+		s_TaskAvailable.notify_one();
+	}
+
+	void ThreadPool::Wait()
+	{
+		std::unique_lock<std::mutex> lock(s_Mutex);
+		s_AllTasksFinished.wait(lock, []() { return s_PendingTasks == 0; });
+	}
+
+	uint32_t ThreadPool::GetPendingTaskCount()
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		return s_PendingTasks;
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		/// Random engine is thread local and has to be seeded for every worker
+		Random::Init();
+
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(s_Mutex);
+				s_TaskAvailable.wait(lock, []() { return !s_Running || !s_Tasks.empty(); });
+
+				/// Queued tasks are still executed during shutdown, so nobody waits for them forever
+				if (s_Tasks.empty())
+					return;
+
+				task = std::move(s_Tasks.front());
+				s_Tasks.pop();
+			}
+
+			task();
+
+			{
+				std::lock_guard<std::mutex> lock(s_Mutex);
+				s_PendingTasks--;
+				if (s_PendingTasks == 0)
+					s_AllTasksFinished.notify_all();
+			}
+		}
+	}
+
+}
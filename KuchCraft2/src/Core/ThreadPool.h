@@ -0,0 +1,82 @@
+///
+/// @file ThreadPool.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ThreadPool class, which runs tasks
+///        on a fixed set of worker threads.
+///
+/// @details The pool should be initialized once at the start of the program via the Init() function.
+///          Tasks are executed in submission order by the first free worker. Results are not returned
+///          by the pool, tasks are expected to hand them back to the main thread on their own,
+///          for example through a ConcurrentQueue.
+///
+/// @note If the pool has not been initialized, submitted tasks are executed immediately on the calling thread.
+///
+/// @thread_safety Submit() and Wait() are thread-safe, Init() and Shutdown() must be called from the main thread.
+///                Wait() must not be called from inside a task.
+///
+/// @example
+///         // Initializing the pool with all but one hardware thread.
+///         KuchCraft::ThreadPool::Init();
+///
+///         // Running work in the background.
+///         KuchCraft::ThreadPool::Submit([chunk]() { chunk->Build(); });
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class ThreadPool
+	{
+	public:
+		/// Starts worker threads.
+		/// @param threadCount - the number of workers, 0 uses all hardware threads but one (at least one worker).
+		static void Init(uint32_t threadCount = 0);
+
+		/// Finishes all queued tasks and joins worker threads.
+		static void Shutdown();
+
+		/// Queues a task to be executed on one of the workers.
+		/// @param task - the task to execute.
+		static void Submit(std::function<void()> task);
+
+		/// Blocks until every queued and running task has finished.
+		static void Wait();
+
+		/// Retrieves the number of worker threads.
+		static inline [[nodiscard]] uint32_t GetThreadCount() { return (uint32_t)s_Workers.size(); }
+
+		/// Retrieves the number of tasks that are queued or running.
+		[[nodiscard]] static uint32_t GetPendingTaskCount();
+
+	private:
+		/// Main loop of a worker thread.
+		static void WorkerLoop();
+
+	private:
+		/// Worker threads.
+		static inline std::vector<std::thread> s_Workers;
+
+		/// Tasks waiting for a free worker.
+		static inline std::queue<std::function<void()>> s_Tasks;
+
+		/// Protects the task queue and counters.
+		static inline std::mutex s_Mutex;
+
+		/// Signaled when a task is queued or the pool is shutting down.
+		static inline std::condition_variable s_TaskAvailable;
+
+		/// Signaled when the pool runs out of work.
+		static inline std::condition_variable s_AllTasksFinished;
+
+		/// Number of tasks that are queued or running.
+		static inline uint32_t s_PendingTasks = 0;
+
+		/// Whether workers should keep waiting for new tasks.
+		static inline bool s_Running = false;
+
+	};
+
+}
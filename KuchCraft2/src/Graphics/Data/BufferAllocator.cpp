@@ -0,0 +1,123 @@
+///
+/// @file BufferAllocator.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "Graphics/Data/BufferAllocator.h"
+
+namespace KuchCraft {
+
+	void BufferAllocator::Init(uint32_t capacity)
+	{
+		m_Capacity        = capacity;
+		m_Used            = 0;
+		m_AllocationCount = 0;
+
+		m_FreeByOffset.clear();
+		m_FreeBySize  .clear();
+
+		if (capacity > 0)
+			InsertFreeRange(0, capacity);
+	}
+
+	BufferAllocation BufferAllocator::Allocate(uint32_t size)
+	{
+		if (size == 0)
+			return {};
+
+		/// Best fit - the smallest free range that can hold the requested size
+		auto bySize = m_FreeBySize.lower_bound(size);
+		if (bySize == m_FreeBySize.end())
+			return {};
+
+		uint32_t rangeOffset = bySize->second;
+		uint32_t rangeSize   = bySize->first;
+		EraseFreeRange(m_FreeByOffset.find(rangeOffset));
+
+		if (rangeSize > size)
+			InsertFreeRange(rangeOffset + size, rangeSize - size);
+
+		m_Used += size;
+		m_AllocationCount++;
+
+		return { rangeOffset, size };
+	}
+
+	void BufferAllocator::Free(const BufferAllocation& allocation)
+	{
+		if (!allocation.IsValid())
+			return;
+
+		uint32_t offset = allocation.Offset;
+		uint32_t size   = allocation.Size;
+
+		/// Merge with the following free range
+		auto next = m_FreeByOffset.find(offset + size);
+		if (next != m_FreeByOffset.end())
+		{
+			size += next->second;
+			EraseFreeRange(next);
+		}
+
+		/// Merge with the preceding free range
+		auto prev = m_FreeByOffset.lower_bound(offset);
+		if (prev != m_FreeByOffset.begin())
+		{
+			--prev;
+			if (prev->first + prev->second == offset)
+			{
+				offset  = prev->first;
+				size   += prev->second;
+				EraseFreeRange(prev);
+			}
+		}
+
+		InsertFreeRange(offset, size);
+
+		m_Used -= allocation.Size;
+		m_AllocationCount--;
+	}
+
+	uint32_t BufferAllocator::GetLargestFreeRange() const
+	{
+		return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first;
+	}
+
+	float BufferAllocator::GetOccupancy() const
+	{
+		return m_Capacity ? (float)m_Used / (float)m_Capacity : 0.0f;
+	}
+
+	float BufferAllocator::GetFragmentation() const
+	{
+		uint32_t freeSpace = m_Capacity - m_Used;
+		if (freeSpace == 0)
+			return 0.0f;
+
+		return 1.0f - (float)GetLargestFreeRange() / (float)freeSpace;
+	}
+
+	void BufferAllocator::InsertFreeRange(uint32_t offset, uint32_t size)
+	{
+		m_FreeByOffset.emplace(offset, size);
+		m_FreeBySize  .emplace(size, offset);
+	}
+
+	void BufferAllocator::EraseFreeRange(std::map<uint32_t, uint32_t>::iterator it)
+	{
+		auto [first, last] = m_FreeBySize.equal_range(it->second);
+		for (auto bySize = first; bySize != last; ++bySize)
+		{
+			if (bySize->second == it->first)
+			{
+				m_FreeBySize.erase(bySize);
+				break;
+			}
+		}
+
+		m_FreeByOffset.erase(it);
+	}
+
+}
@@ -0,0 +1,97 @@
+///
+/// @file BufferAllocator.h
+///
+/// @author Michal Kuchnicki
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	/// Describes a range suballocated from a larger buffer.
+	struct BufferAllocation
+	{
+		/// Offset of the range in allocator units.
+		uint32_t Offset = 0;
+
+		/// Size of the range in allocator units, 0 if the allocation is invalid.
+		uint32_t Size = 0;
+
+		/// Checks if the allocation holds a valid range.
+		/// @return True if valid, false otherwise.
+		inline [[nodiscard]] bool IsValid() const { return Size != 0; }
+	};
+
+	/// CPU side free-list allocator used to manage ranges of a single large GPU buffer.
+	/// Uses best-fit selection and coalesces neighboring free ranges on release.
+	/// Units are chosen by the user (bytes, vertices, ...), the allocator only tracks numbers.
+	class BufferAllocator
+	{
+	public:
+		BufferAllocator() = default;
+
+		~BufferAllocator() = default;
+
+		/// Resets the allocator to a single free range covering the whole capacity.
+		/// @param capacity - the total number of units that can be allocated.
+		void Init(uint32_t capacity);
+
+		/// Allocates a range of a given size.
+		/// @param size - the number of units to allocate.
+		/// @return The allocated range, or an invalid allocation if there is no free range big enough.
+		[[nodiscard]] BufferAllocation Allocate(uint32_t size);
+
+		/// Returns a range to the allocator, merging it with neighboring free ranges.
+		/// Invalid allocations are ignored.
+		/// @param allocation - the range to release.
+		void Free(const BufferAllocation& allocation);
+
+		/// Gets the total number of units managed by the allocator.
+		inline [[nodiscard]] uint32_t GetCapacity() const { return m_Capacity; }
+
+		/// Gets the number of allocated units.
+		inline [[nodiscard]] uint32_t GetUsed() const { return m_Used; }
+
+		/// Gets the number of live allocations.
+		inline [[nodiscard]] uint32_t GetAllocationCount() const { return m_AllocationCount; }
+
+		/// Gets the number of separate free ranges.
+		inline [[nodiscard]] uint32_t GetFreeRangeCount() const { return (uint32_t)m_FreeByOffset.size(); }
+
+		/// Gets the size of the biggest free range.
+		[[nodiscard]] uint32_t GetLargestFreeRange() const;
+
+		/// Gets the ratio of used units to capacity.
+		/// @return Value in range [0, 1].
+		[[nodiscard]] float GetOccupancy() const;
+
+		/// Gets external fragmentation of the free space, defined as 1 - largest free range / total free space.
+		/// @return Value in range [0, 1], 0 when all free space is contiguous.
+		[[nodiscard]] float GetFragmentation() const;
+
+	private:
+		/// Inserts a free range into both lookup structures.
+		void InsertFreeRange(uint32_t offset, uint32_t size);
+
+		/// Removes a free range from both lookup structures.
+		void EraseFreeRange(std::map<uint32_t, uint32_t>::iterator it);
+
+	private:
+		/// Total number of units.
+		uint32_t m_Capacity = 0;
+
+		/// Number of allocated units.
+		uint32_t m_Used = 0;
+
+		/// Number of live allocations.
+		uint32_t m_AllocationCount = 0;
+
+		/// Free ranges ordered by offset, used for coalescing.
+		std::map<uint32_t, uint32_t> m_FreeByOffset;
+
+		/// Free ranges ordered by size, used for best-fit search.
+		std::multimap<uint32_t, uint32_t> m_FreeBySize;
+
+	};
+
+}
@@ -0,0 +1,45 @@
+///
+/// @file IndirectBuffer.cpp
+/// 
+/// @author Michal Kuchnicki
+/// 
+
+#include "kcpch.h"
+#include "Graphics/Data/IndirectBuffer.h"
+
+#include <glad/glad.h>
+
+namespace KuchCraft {
+
+	IndirectBuffer::~IndirectBuffer()
+	{
+		glDeleteBuffers(1, &m_RendererID);
+	}
+
+	void IndirectBuffer::Create(uint32_t commandCount)
+	{
+		if (m_RendererID)
+			glDeleteBuffers(1, &m_RendererID);
+
+		m_Capacity = commandCount;
+
+		glCreateBuffers(1, &m_RendererID);
+		glNamedBufferData(m_RendererID, commandCount * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	void IndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, uint32_t count)
+	{
+		glNamedBufferSubData(m_RendererID, 0, count * sizeof(DrawElementsIndirectCommand), commands);
+	}
+
+	void IndirectBuffer::Bind() const
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+	}
+
+	void IndirectBuffer::Unbind() const
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+}
@@ -0,0 +1,65 @@
+///
+/// @file IndirectBuffer.h
+/// 
+/// @author Michal Kuchnicki
+/// 
+
+#pragma once
+
+namespace KuchCraft {
+
+	/// Layout of a single command consumed by `glMultiDrawElementsIndirect`.
+	struct DrawElementsIndirectCommand
+	{
+		/// Number of indices to draw.
+		uint32_t Count = 0;
+
+		/// Number of instances to draw.
+		uint32_t InstanceCount = 1;
+
+		/// First index within the bound index buffer.
+		uint32_t FirstIndex = 0;
+
+		/// Value added to each index before fetching the vertex.
+		int32_t BaseVertex = 0;
+
+		/// First instance, available to shaders as gl_BaseInstance.
+		uint32_t BaseInstance = 0;
+	};
+
+	class IndirectBuffer
+	{
+	public:
+		IndirectBuffer() = default;
+
+		/// Cleaning up the indirect buffer
+		~IndirectBuffer();
+
+		/// Creates an indirect buffer able to hold a given number of draw commands.
+		/// @param commandCount - the maximum number of commands stored in the buffer.
+		void Create(uint32_t commandCount);
+
+		/// Updates the draw commands stored in the buffer.
+		/// @param commands - pointer to the commands.
+		/// @param count - the number of commands.
+		void SetData(const DrawElementsIndirectCommand* commands, uint32_t count);
+
+		/// Binds the buffer as the current draw indirect buffer.
+		void Bind() const;
+
+		/// Unbinds the draw indirect buffer.
+		void Unbind() const;
+
+		/// Gets the maximum number of commands that fit in the buffer.
+		inline [[nodiscard]] uint32_t GetCapacity() const { return m_Capacity; }
+
+	private:
+		/// ID of the OpenGL buffer object
+		uint32_t m_RendererID = 0;
+
+		/// Maximum number of commands
+		uint32_t m_Capacity = 0;
+
+	};
+
+}
@@ -0,0 +1,71 @@
+///
+/// @file StorageBuffer.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "Graphics/Data/StorageBuffer.h"
+
+#include <glad/glad.h>
+
+namespace KuchCraft {
+
+	static inline uint32_t s_NextAvailableBinding = 0;
+	static inline std::set<uint32_t> s_FreeBindings;
+
+	static uint32_t AllocateBinding()
+	{
+		if (!s_FreeBindings.empty())
+		{
+			auto it = s_FreeBindings.begin();
+			uint32_t binding = *it;
+			s_FreeBindings.erase(it);
+			return binding;
+		}
+
+		return s_NextAvailableBinding++;
+	}
+
+	static void ReleaseBinding(uint32_t binding)
+	{
+		s_FreeBindings.insert(binding);
+	}
+
+	StorageBuffer::StorageBuffer()
+	{
+
+	}
+
+	StorageBuffer::~StorageBuffer()
+	{
+		glDeleteBuffers(1, &m_RendererID);
+
+		if (m_HasBinding)
+			ReleaseBinding(m_Binding);
+	}
+
+	void StorageBuffer::Create(uint32_t size)
+	{
+		if (m_RendererID)
+			glDeleteBuffers(1, &m_RendererID);
+
+		if (!m_HasBinding)
+		{
+			m_Binding    = AllocateBinding();
+			m_HasBinding = true;
+		}
+
+		m_Size = size;
+
+		glCreateBuffers(1, &m_RendererID);
+		glNamedBufferData(m_RendererID, size, nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Binding, m_RendererID);
+	}
+
+	void StorageBuffer::SetData(const void* data, uint32_t size, uint32_t offset)
+	{
+		glNamedBufferSubData(m_RendererID, offset, size, data);
+	}
+
+}
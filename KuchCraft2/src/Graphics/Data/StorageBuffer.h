@@ -0,0 +1,51 @@
+///
+/// @file StorageBuffer.h
+///
+/// @author Michal Kuchnicki
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class StorageBuffer
+	{
+	public:
+		/// Initializes an empty StorageBuffer without allocating any GPU memory.
+		StorageBuffer();
+
+		/// Deletes GPU resources associated with this StorageBuffer and releases its binding number
+		~StorageBuffer();
+
+		/// Creates a SSBO on the GPU and assigns it a binding.
+		/// Recreating an existing buffer keeps its binding, so shaders do not have to be recompiled.
+		/// @param size - the size of the buffer in bytes to be allocated on the GPU.
+		void Create(uint32_t size);
+
+		/// Updates data in the SSBO.
+		/// @param data - a pointer to the data to be uploaded to the buffer.
+		/// @param size - the size of the data in bytes to be uploaded.
+		/// @param offset - the offset in bytes from the start of the buffer where the data should be written.
+		void SetData(const void* data, uint32_t size, uint32_t offset = 0);
+
+		/// Get size of storage buffer
+		uint32_t GetSize() const { return m_Size; }
+
+		/// Get binding of storage buffer
+		uint32_t GetBinding() const { return m_Binding; }
+
+	private:
+		/// OpenGL ID for the buffer object
+		uint32_t m_RendererID = 0;
+
+		/// The size of the buffer in bytes
+		uint32_t m_Size = 0;
+
+		/// The binding assigned to this buffer
+		uint32_t m_Binding = 0;
+
+		/// Whether the binding was already assigned
+		bool m_HasBinding = false;
+	};
+
+}
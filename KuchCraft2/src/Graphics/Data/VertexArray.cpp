@@ -35,6 +35,9 @@ namespace KuchCraft {
 
 	void VertexArray::Create()
 	{
+		if (m_RendererID)
+			glDeleteVertexArrays(1, &m_RendererID);
+
 		glCreateVertexArrays(1, &m_RendererID);
 		Bind();
 	}
@@ -32,6 +32,10 @@ namespace KuchCraft {
 		/// Unbinds the vertex array, making no vertex array bound in OpenGL.
 		void Unbind() const;
 
+		/// Gets the OpenGL ID of the vertex array.
+		/// @return The ID, or 0 if the vertex array has not been created yet.
+		inline [[nodiscard]] uint32_t GetRendererID() const { return m_RendererID; }
+
 	private:
 		/// ID of the OpenGL vertex array
 		uint32_t m_RendererID = 0;
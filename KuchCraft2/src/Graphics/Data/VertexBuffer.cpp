@@ -26,10 +26,10 @@ namespace KuchCraft {
 		glBufferData(GL_ARRAY_BUFFER, size, data, usage == VertexBufferDataUsage::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
 	}
 
-	void VertexBuffer::SetData(uint32_t size, const void* data)
+	void VertexBuffer::SetData(uint32_t size, const void* data, uint32_t offset)
 	{
 		glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
 	}
 
 	void VertexBuffer::Bind() const
@@ -37,7 +37,8 @@ namespace KuchCraft {
 		/// Updates the data in the vertex buffer.
 		/// @param size - the size of the data in bytes.
 		/// @param data - pointer to the data to store in the buffer.
-		void SetData(uint32_t size, const void* data);
+		/// @param offset - the offset in bytes from the start of the buffer where the data should be written.
+		void SetData(uint32_t size, const void* data, uint32_t offset = 0);
 
 		/// Sets the buffer layout, which describes how the vertex data is organized.
 		/// @param bufferLayout - the layout of the buffer data.
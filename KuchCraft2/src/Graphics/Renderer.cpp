@@ -24,6 +24,9 @@
 
 namespace KuchCraft {
 
+	/// Initial number of chunk draw commands the indirect and storage buffers can hold, they grow on demand
+	constexpr uint32_t chunk_initial_draw_capacity = 1024;
+
 #pragma region Lifecycle 
 	void Renderer::Init()
 	{
@@ -54,12 +57,13 @@ namespace KuchCraft {
 		/// Init texture manager
 		TextureManager::Init();
 
+		/// Create uniform and storage buffers, their bindings are needed by shader substitutions
+		s_Data.CameraDataUniformBuffer.Create(sizeof(CameraDataUniformBuffer));
+		s_ChunkData.PositionsStorageBuffer.Create(chunk_initial_draw_capacity * sizeof(glm::vec4));
+
 		/// Adds dynamic substitutions for shaders (constants and configurations)
 		AddSubstitutions();
 
-		/// Create uniform buffers
-		s_Data.CameraDataUniformBuffer.Create(sizeof(CameraDataUniformBuffer));
-
 		/// Initializes resources
 		InitQuads2D();
 		InitQuads3D();
@@ -122,8 +126,12 @@ namespace KuchCraft {
 			s_Stats.fpsTracker      .RenderImGui("Fps");
 			s_Stats.drawCallsTracker.RenderImGui("Draw calls");
 			s_Stats.verticesTracker .RenderImGui("Vertices");
+			s_Stats.uploadedBytesTracker.RenderImGui("Uploaded bytes");
 		}
 
+		if (ImGui::CollapsingHeader("Chunk buffer"))
+			RenderChunksImGui();
+
 		if (ImGui::CollapsingHeader("Shaders") && !s_Data.ShaderLibrary.GetShaders().empty())
 		{
 			if (ImGui::Button("Recompile all", ImVec2(ImGui::GetContentRegionAvail().x, 0.0f)))
@@ -493,6 +501,11 @@ namespace KuchCraft {
 		s_ChunkData.Chunks.push_back(chunk);
 	}
 
+	void Renderer::ReleaseChunkMesh(const BufferAllocation& allocation)
+	{
+		s_ChunkData.Allocator.Free(allocation);
+	}
+
 #pragma endregion
 #pragma region Shaders
 
@@ -514,6 +527,7 @@ namespace KuchCraft {
 	{
 		s_Data.ShaderLibrary.AddSubstitution(std::make_pair("SHADER_VERSION", ApplicationConfig::GetRendererData().ShaderVersion));
 		s_Data.ShaderLibrary.AddSubstitution(std::make_pair("UNIFORM_CAMERA_DATA_BINDING", std::to_string(s_Data.CameraDataUniformBuffer.GetBinding())));
+		s_Data.ShaderLibrary.AddSubstitution(std::make_pair("STORAGE_CHUNK_POSITIONS_BINDING", std::to_string(s_ChunkData.PositionsStorageBuffer.GetBinding())));
 
 		GLint maxArrayTextureLayers; glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayTextureLayers);
 		s_Data.ShaderLibrary.AddSubstitution(std::make_pair("MAX_ARRAY_TEXTURE_LAYERS", std::to_string(maxArrayTextureLayers)));
@@ -667,6 +681,7 @@ namespace KuchCraft {
 		uint32_t vertexCount = s_Quad2DData.IndexCount / quad_index_count * quad_vertex_count;
 		s_Quad2DData.VertexBuffer.SetData(vertexCount * sizeof(Primitives::_2D::QuadVertex), &s_Quad2DData.Vertices[s_Quad2DData.VertexOffset]);
 		s_Quad2DData.VertexOffset += vertexCount;
+		s_Stats.UploadedBytes += vertexCount * sizeof(Primitives::_2D::QuadVertex);
 
 		for (uint32_t i = 0; i < s_Quad2DData.TextureSlotIndex; i++)
 			Texture::Bind(s_Quad2DData.TextureSlots[i], i);
@@ -815,6 +830,7 @@ namespace KuchCraft {
 		uint32_t vertexCount = s_Quad3DData.IndexCount / quad_index_count * quad_vertex_count;
 		s_Quad3DData.VertexBuffer.SetData(vertexCount * sizeof(Primitives::_3D::QuadVertex), &s_Quad3DData.Vertices[s_Quad3DData.VertexOffset]);
 		s_Quad3DData.VertexOffset += vertexCount;
+		s_Stats.UploadedBytes += vertexCount * sizeof(Primitives::_3D::QuadVertex);
 
 		for (uint32_t i = 0; i < s_Quad3DData.TextureSlotIndex; i++)
 			Texture::Bind(s_Quad3DData.TextureSlots[i], i);
@@ -841,13 +857,18 @@ namespace KuchCraft {
 
 	void Renderer::InitChunks()
 	{
+		/// Shared vertex buffer for all chunk meshes, managed in vertex units
+		constexpr uint32_t vertex_size = 2 * sizeof(uint32_t);
+		uint32_t capacity = (uint32_t)((uint64_t)ApplicationConfig::GetRendererData().ChunkBufferSizeMB * 1024 * 1024 / vertex_size);
+
 		s_ChunkData.VertexArray .Create();
-		s_ChunkData.VertexBuffer.Create(VertexBufferDataUsage::DYNAMIC, chunk_size_XZ * chunk_size_XZ * chunk_size_XZ * block_face_count * block_vertex_count * 2 * sizeof(uint32_t));
+		s_ChunkData.VertexBuffer.Create(VertexBufferDataUsage::DYNAMIC, capacity * vertex_size);
 		s_ChunkData.VertexBuffer.SetBufferLayout({
 			{ ShaderDataType::Uint, "a_PackedData1" },
 			{ ShaderDataType::Uint, "a_PackedData2" },
 		});
 		s_ChunkData.VertexArray.SetVertexBuffer(s_ChunkData.VertexBuffer);
+		s_ChunkData.Allocator.Init(capacity);
 
 		constexpr int max_indices = chunk_size_XZ * chunk_size_XZ * chunk_size_XZ * block_face_count * block_index_count;
 		uint32_t* indices = new uint32_t[max_indices];
@@ -864,13 +885,16 @@ namespace KuchCraft {
 			offset += quad_vertex_count;
 		}
 		s_ChunkData.IndexBuffer.Create(IndexBufferDataUsage::STATIC, max_indices, indices);
+		s_ChunkData.IndexBuffer.Bind();
 		delete[] indices;
 
+		s_ChunkData.IndirectBuffer.Create(chunk_initial_draw_capacity);
+		s_ChunkData.Commands .reserve(chunk_initial_draw_capacity);
+		s_ChunkData.Positions.reserve(chunk_initial_draw_capacity);
+
 		s_ChunkData.Shader = s_Data.ShaderLibrary.Load("assets/shaders/chunk.glsl");
 		s_ChunkData.Shader->Bind();
 
-		// TODO: s_ChunkData.Chunks.reserve();
-
 		s_ChunkData.VertexArray .Unbind();
 		s_ChunkData.VertexBuffer.Unbind();
 	}
@@ -880,34 +904,106 @@ namespace KuchCraft {
 		if (!s_ChunkData.Chunks.size())
 			return;
 
+		/// Build draw commands, meshes are sent to the GPU only once after being rebuilt
+		s_ChunkData.Commands .clear();
+		s_ChunkData.Positions.clear();
+
+		for (const auto& chunk : s_ChunkData.Chunks)
+		{
+			auto& renderData = chunk->GetRenderData();
+			if (renderData.NeedsUpload() && !UploadChunkMesh(renderData))
+				continue;
+
+			uint32_t quadCount = renderData.GetQuadCount();
+			if (!quadCount)
+				continue;
+
+			DrawElementsIndirectCommand command;
+			command.Count      = quadCount * quad_index_count;
+			command.BaseVertex = (int32_t)renderData.GetAllocation().Offset;
+			s_ChunkData.Commands .push_back(command);
+			s_ChunkData.Positions.push_back(glm::vec4(chunk->GetPosition() + glm::vec3(0.5f, 0.5f, 0.5f), 0.0f));
+
+			s_Stats.Vertices += quadCount * quad_vertex_count;
+		}
+
+		s_ChunkData.Chunks.clear();
+
+		uint32_t drawCount = (uint32_t)s_ChunkData.Commands.size();
+		if (!drawCount)
+			return;
+
+		if (drawCount > s_ChunkData.IndirectBuffer.GetCapacity())
+		{
+			uint32_t capacity = std::max(drawCount, 2 * s_ChunkData.IndirectBuffer.GetCapacity());
+			s_ChunkData.IndirectBuffer        .Create(capacity);
+			s_ChunkData.PositionsStorageBuffer.Create(capacity * sizeof(glm::vec4));
+		}
+
+		s_ChunkData.IndirectBuffer        .SetData(s_ChunkData.Commands.data(), drawCount);
+		s_ChunkData.PositionsStorageBuffer.SetData(s_ChunkData.Positions.data(), drawCount * sizeof(glm::vec4));
+		s_Stats.UploadedBytes += drawCount * (sizeof(DrawElementsIndirectCommand) + sizeof(glm::vec4));
+
 		EnableBlending();
 		EnableFaceCulling();
 		EnableDepthTesting();
 
-		s_ChunkData.Shader     ->Bind();
-		s_ChunkData.VertexArray .Bind();
-		s_ChunkData.IndexBuffer .Bind();
-		s_ChunkData.VertexBuffer.Bind();
+		s_ChunkData.Shader        ->Bind();
+		s_ChunkData.VertexArray    .Bind();
+		s_ChunkData.IndirectBuffer .Bind();
 
 		ItemMenager::GetTextureArray()->Bind();
 
-		for (const auto& chunk : s_ChunkData.Chunks)
+		MultiDrawElementsIndirect(drawCount);
+		s_Stats.DrawCalls++;
+
+		s_ChunkData.IndirectBuffer.Unbind();
+		s_ChunkData.VertexArray   .Unbind();
+	}
+
+	bool Renderer::UploadChunkMesh(ChunkRenderData& renderData)
+	{
+		constexpr uint32_t vertex_size = 2 * sizeof(uint32_t);
+
+		const auto& data = renderData.GetData();
+		uint32_t vertexCount = (uint32_t)data.size() / 2;
+
+		/// The old range stays valid until the new one is allocated, so a failed upload keeps drawing the previous mesh
+		/// and the CPU copy is kept to retry once other meshes release their ranges
+		BufferAllocation allocation = s_ChunkData.Allocator.Allocate(vertexCount);
+		if (vertexCount && !allocation.IsValid())
 		{
-			s_ChunkData.Shader->SetFloat3("u_ChunkPosition", chunk->GetPosition() + glm::vec3(0.5f, 0.5f, 0.5f));
-			
-			const auto& renderData = chunk->GetRenderData();
-			s_ChunkData.VertexBuffer.SetData((uint32_t)(renderData.GetData().size() * 2 * sizeof(uint32_t)) , renderData.GetData().data());
+			Log::Warn("[Renderer] : Chunk buffer is full, failed to allocate {} vertices", vertexCount);
+			return renderData.GetAllocation().IsValid();
+		}
 
-			uint32_t quadCount   = (uint32_t)renderData.GetData().size() / (2 * quad_vertex_count);
-			uint32_t indexCount  = quadCount * quad_index_count;
-			uint32_t vertexCount = quadCount * quad_vertex_count;
-			DrawElements(indexCount);
+		s_ChunkData.Allocator.Free(renderData.GetAllocation());
 
-			s_Stats.Vertices += vertexCount;
-			s_Stats.DrawCalls++;
+		if (vertexCount)
+		{
+			s_ChunkData.VertexBuffer.SetData(vertexCount * vertex_size, data.data(), allocation.Offset * vertex_size);
+			s_Stats.UploadedBytes += vertexCount * vertex_size;
 		}
 
-		s_ChunkData.Chunks.clear();
+		renderData.OnUploaded(allocation);
+		return true;
+	}
+
+	void Renderer::RenderChunksImGui()
+	{
+#ifdef  INCLUDE_IMGUI
+		constexpr float vertex_size = 2.0f * sizeof(uint32_t);
+		constexpr float mega_byte   = 1024.0f * 1024.0f;
+
+		const auto& allocator = s_ChunkData.Allocator;
+		ImGui::Text("Occupancy: %.2f / %.2f MB (%.1f%%)",
+			allocator.GetUsed() * vertex_size / mega_byte, allocator.GetCapacity() * vertex_size / mega_byte, allocator.GetOccupancy() * 100.0f);
+		ImGui::Text("Meshes: %u", allocator.GetAllocationCount());
+		ImGui::Text("Free ranges: %u", allocator.GetFreeRangeCount());
+		ImGui::Text("Largest free range: %.2f MB", allocator.GetLargestFreeRange() * vertex_size / mega_byte);
+		ImGui::Text("Fragmentation: %.1f%%", allocator.GetFragmentation() * 100.0f);
+		ImGui::ProgressBar(allocator.GetOccupancy());
+#endif
 	}
 
 #pragma endregion
@@ -928,6 +1024,11 @@ namespace KuchCraft {
 		glDrawArraysInstanced(GL_TRIANGLE_STRIP, offset, count, instanceCount);
 	}
 
+	void Renderer::MultiDrawElementsIndirect(uint32_t drawCount)
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, 0);
+	}
+
 	void Renderer::EnableBlending()
 	{
 		glEnable(GL_BLEND);
@@ -84,6 +84,10 @@ namespace KuchCraft {
 		/// @param chunk - poiter to specific chunk
 		static void DrawChunk(Chunk* chunk);
 
+		/// Releases the range of the shared chunk vertex buffer held by a chunk mesh.
+		/// @param allocation - the range to release, invalid ranges are ignored.
+		static void ReleaseChunkMesh(const BufferAllocation& allocation);
+
 	#pragma endregion
 	#pragma region Shaders
 	public:
@@ -189,6 +193,14 @@ namespace KuchCraft {
 		/// This function handles the rendering of chunks
 		static void RenderChunks();
 
+		/// Copies a rebuilt chunk mesh into its range of the shared chunk vertex buffer.
+		/// @param renderData - render data of the chunk holding the rebuilt mesh.
+		/// @return True if the mesh is resident, false if the shared buffer has no room for it.
+		static bool UploadChunkMesh(ChunkRenderData& renderData);
+
+		/// Renders ImGui statistics of the shared chunk vertex buffer.
+		static void RenderChunksImGui();
+
 	#pragma endregion
 	#pragma region RendererCommands
 	private:
@@ -210,6 +222,11 @@ namespace KuchCraft {
 		/// @param offset - the starting index of the vertex data.
 		static void DrawStripArraysInstanced(uint32_t count, uint32_t instanceCount, uint32_t offset);
 
+		/// Issues a single draw call for multiple indexed draws described in the bound indirect buffer.
+		/// Wraps the OpenGL `glMultiDrawElementsIndirect` function.
+		/// @param drawCount - the number of draw commands to execute.
+		static void MultiDrawElementsIndirect(uint32_t drawCount);
+
 		/// Enables blending in OpenGL.
 		/// Configures the blend function to handle transparency using source alpha.
 		static void EnableBlending();
@@ -17,6 +17,9 @@
 #include "Graphics/Data/VertexArray.h"
 #include "Graphics/Data/IndexBuffer.h"
 #include "Graphics/Data/UniformBuffer.h"
+#include "Graphics/Data/StorageBuffer.h"
+#include "Graphics/Data/IndirectBuffer.h"
+#include "Graphics/Data/BufferAllocator.h"
 #include "Graphics/Data/Camera.h"
 #include "Graphics/Data/Primitives.h"
 #include "Graphics/Data/Texture.h"
@@ -46,19 +49,25 @@ namespace KuchCraft {
 		/// Number of vertices processed in the current frame.
 		uint32_t Vertices = 0;
 
+		/// Number of bytes uploaded to the GPU in the current frame.
+		uint32_t UploadedBytes = 0;
+
 		/// Trackers
 		MetricTracker<float, 500>    fpsTracker;
 		MetricTracker<uint32_t, 500> drawCallsTracker;
 		MetricTracker<uint32_t, 500> verticesTracker;
+		MetricTracker<uint32_t, 500> uploadedBytesTracker;
 
 		/// Resets the statistics for the current frame and updates the historical trackers.
 		void Reset()
 		{
-			drawCallsTracker.AddValue(DrawCalls);
-			verticesTracker .AddValue(Vertices);
+			drawCallsTracker    .AddValue(DrawCalls);
+			verticesTracker     .AddValue(Vertices);
+			uploadedBytesTracker.AddValue(UploadedBytes);
 
-			DrawCalls = 0;
-			Vertices  = 0;
+			DrawCalls     = 0;
+			Vertices      = 0;
+			UploadedBytes = 0;
 		}
 	};
 
@@ -160,13 +169,31 @@ namespace KuchCraft {
 
 	class Chunk;
 
+	/// Stores data related to chunk rendering.
+	/// All chunk meshes live in one shared vertex buffer, each chunk owns a range of it
+	/// handed out by the allocator. Visible chunks are drawn with a single multi draw indirect call,
+	/// chunk positions are read from a storage buffer indexed by gl_DrawID.
 	struct ChunkRendererData
 	{
+		/// Chunks submitted for drawing in the current frame.
 		std::vector<Chunk*> Chunks;
+
+		/// Draw commands built every frame from the submitted chunks.
+		std::vector<DrawElementsIndirectCommand> Commands;
+
+		/// Chunk positions built every frame, one per draw command.
+		std::vector<glm::vec4> Positions;
+
+		/// Manages ranges (in vertices) of the shared vertex buffer.
+		BufferAllocator Allocator;
+
+		///...
 		std::shared_ptr<Shader> Shader;
-		IndexBuffer  IndexBuffer;
-		VertexArray  VertexArray;
-		VertexBuffer VertexBuffer;
+		IndexBuffer    IndexBuffer;
+		VertexArray    VertexArray;
+		VertexBuffer   VertexBuffer;
+		IndirectBuffer IndirectBuffer;
+		StorageBuffer  PositionsStorageBuffer;
 	};
 
 	/// Stores data related to camera transformations
@@ -8,7 +8,136 @@
 
 namespace KuchCraft {
 
+	/// Number of climate grid cells along every axis
+	constexpr int climate_grid_size = 16;
+
+	/// Biomes further than this from a climate are never selected
+	constexpr float max_biome_distance = 1.0f;
+
+	/// Margin for float rounding when cells are tested against biome distances
+	constexpr float climate_grid_epsilon = 1e-4f;
+
 	void BiomeMenager::Reload()
+	{
+		LoadBiomePack();
+		BuildClimateLookup();
+	}
+
+	const BiomeInfo* BiomeMenager::Select(float temperature, float humidity, float continentalness)
+	{
+		glm::vec3 climate = { temperature, humidity, continentalness };
+
+		/// Also catches NaN, those climates are checked against every biome
+		bool inGrid = climate.x >= 0.0f && climate.x <= 1.0f && climate.y >= 0.0f && climate.y <= 1.0f && climate.z >= 0.0f && climate.z <= 1.0f;
+		if (!inGrid || s_CellOffsets.empty())
+			return SelectFrom(s_AllCandidates.data(), (uint32_t)s_AllCandidates.size(), climate);
+
+		glm::ivec3 cell = glm::min(glm::ivec3(climate * (float)climate_grid_size), glm::ivec3(climate_grid_size - 1));
+		uint32_t   index = (uint32_t)((cell.x * climate_grid_size + cell.y) * climate_grid_size + cell.z);
+
+		return SelectFrom(&s_CellCandidates[s_CellOffsets[index]], s_CellOffsets[index + 1] - s_CellOffsets[index], climate);
+	}
+
+	const BiomeInfo* BiomeMenager::SelectFrom(const uint16_t* candidates, uint32_t count, const glm::vec3& climate)
+	{
+		if (s_Biomes.empty())
+			return nullptr;
+
+		const BiomeInfo* selected  = nullptr;
+		float            bestMatch = max_biome_distance;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const glm::vec3& center = s_ClimateCenters[candidates[i]];
+
+			float tempDiff   = glm::abs(climate.x - center.x);
+			float humDiff    = glm::abs(climate.y - center.y);
+			float contDiff   = glm::abs(climate.z - center.z);
+			float biomeMatch = tempDiff + humDiff + contDiff;
+
+			if (biomeMatch < bestMatch)
+			{
+				bestMatch = biomeMatch;
+				selected  = s_Biomes[candidates[i]];
+			}
+		}
+
+		return selected ? selected : s_Biomes.front();
+	}
+
+	void BiomeMenager::BuildClimateLookup()
+	{
+		s_Biomes.clear();
+		s_ClimateCenters.clear();
+		s_AllCandidates.clear();
+		s_CellOffsets.clear();
+		s_CellCandidates.clear();
+
+		for (const auto& [name, biome] : s_Data)
+		{
+			s_AllCandidates.push_back((uint16_t)s_Biomes.size());
+			s_Biomes.push_back(&biome);
+			s_ClimateCenters.push_back({
+				glm::mix(biome.Climate.MinTemperature,     biome.Climate.MaxTemperature,     0.5f),
+				glm::mix(biome.Climate.MinHumidity,        biome.Climate.MaxHumidity,        0.5f),
+				glm::mix(biome.Terrain.MinContinentalness, biome.Terrain.MaxContinentalness, 0.5f)
+			});
+		}
+
+		if (s_Biomes.empty())
+			return;
+
+		/// The closest and farthest points of a cell along one axis
+		auto axisDistances = [](float center, float cellMin, float cellMax) {
+			float nearest  = center < cellMin ? cellMin - center : (center > cellMax ? center - cellMax : 0.0f);
+			float farthest = std::max(glm::abs(center - cellMin), glm::abs(center - cellMax));
+			return glm::vec2(nearest, farthest);
+		};
+
+		/// A biome can win somewhere in a cell only if its closest point in the cell is not farther than
+		/// the farthest point of the biome with the best guaranteed distance, candidates keep the s_Biomes order
+		/// so ties are resolved exactly like when checking every biome
+		std::vector<glm::vec2> distances(s_Biomes.size());
+		s_CellOffsets.reserve(climate_grid_size * climate_grid_size * climate_grid_size + 1);
+
+		for (int x = 0; x < climate_grid_size; x++)
+		{
+			for (int y = 0; y < climate_grid_size; y++)
+			{
+				for (int z = 0; z < climate_grid_size; z++)
+				{
+					glm::vec3 cellMin = glm::vec3(x, y, z) / (float)climate_grid_size;
+					glm::vec3 cellMax = glm::vec3(x + 1, y + 1, z + 1) / (float)climate_grid_size;
+
+					float bestFarthest = std::numeric_limits<float>::max();
+					for (size_t i = 0; i < s_Biomes.size(); i++)
+					{
+						const glm::vec3& center = s_ClimateCenters[i];
+						distances[i] = axisDistances(center.x, cellMin.x, cellMax.x)
+						             + axisDistances(center.y, cellMin.y, cellMax.y)
+						             + axisDistances(center.z, cellMin.z, cellMax.z);
+
+						bestFarthest = std::min(bestFarthest, distances[i].y);
+					}
+
+					s_CellOffsets.push_back((uint32_t)s_CellCandidates.size());
+					for (size_t i = 0; i < s_Biomes.size(); i++)
+					{
+						float nearest = distances[i].x - climate_grid_epsilon;
+						if (nearest <= bestFarthest && nearest < max_biome_distance)
+							s_CellCandidates.push_back((uint16_t)i);
+					}
+				}
+			}
+		}
+
+		s_CellOffsets.push_back((uint32_t)s_CellCandidates.size());
+
+		Log::Info("[BiomeMenager] : Climate lookup built, {:.2f} candidate biomes per cell on average",
+			(float)s_CellCandidates.size() / (climate_grid_size * climate_grid_size * climate_grid_size));
+	}
+
+	void BiomeMenager::LoadBiomePack()
 	{
 		std::ifstream file(ApplicationConfig::GetWorldData().BiomePackFile);
 		if (!file.is_open())
@@ -40,6 +169,13 @@ namespace KuchCraft {
 				continue;
 			}
 	
+			/// Chunks keep biome ids in a single byte per column
+			if (!biome["id"].is_number_integer() || biome["id"] < 0 || biome["id"] > 255)
+			{
+				Log::Error("[BiomeMenager] : Biome id must be an integer in range [0, 255]");
+				continue;
+			}
+
 			std::string name = biome["name"];
 			s_Data[name] = BiomeInfo{};
 			BiomeInfo& info = s_Data[name];
@@ -14,8 +14,36 @@ namespace KuchCraft {
 		/// @return A reference to the map of BiomeInfo.
 		static const std::unordered_map<std::string, BiomeInfo>& Get() { return s_Data; }
 
+		/// Selects the biome whose climate center is the closest to the given climate (sum of absolute differences).
+		/// Biomes further than 1.0 are not selected, the first biome is returned if none is close enough.
+		/// Climate inside [0, 1] only checks the few biomes that can win in its lookup cell.
+		/// @return The selected biome, or nullptr if no biomes are loaded.
+		static const BiomeInfo* Select(float temperature, float humidity, float continentalness);
+
+	private:
+		/// Loads biome information from the biome pack file.
+		static void LoadBiomePack();
+
+		/// Builds the climate lookup grid from the loaded biomes.
+		static void BuildClimateLookup();
+
+		/// Finds the closest biome among candidates given by their indices into s_Biomes.
+		static const BiomeInfo* SelectFrom(const uint16_t* candidates, uint32_t count, const glm::vec3& climate);
+
 	private:
 		/// Storage for biome information.
 		static inline std::unordered_map<std::string, BiomeInfo> s_Data;
+
+		/// Biomes in the iteration order of s_Data and their climate centers (temperature, humidity, continentalness).
+		static inline std::vector<const BiomeInfo*> s_Biomes;
+		static inline std::vector<glm::vec3>        s_ClimateCenters;
+
+		/// Indices of all biomes, used for climate outside the lookup grid.
+		static inline std::vector<uint16_t> s_AllCandidates;
+
+		/// Biomes that can be selected in every cell of the climate grid, cell i uses
+		/// s_CellCandidates[s_CellOffsets[i]] up to s_CellCandidates[s_CellOffsets[i + 1]].
+		static inline std::vector<uint32_t> s_CellOffsets;
+		static inline std::vector<uint16_t> s_CellCandidates;
 	};
 }
\ No newline at end of file
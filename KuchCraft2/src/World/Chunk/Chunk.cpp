@@ -2,6 +2,8 @@
 #include "Chunk.h"
 #include "World/World/World.h"
 #include "World/WorldGenerator/WorldGenerator.h"
+#include "World/Item/ItemMenager.h"
+#include "Core/Config.h"
 
 namespace KuchCraft {
 
@@ -12,60 +14,252 @@ namespace KuchCraft {
 
 	Chunk::~Chunk()
 	{
+		UnlinkNeighbors();
 	}
 
-	void Chunk::OnUpdate(float dt)
+	static_assert(chunk_block_count - 1 <= UINT16_MAX, "Chunk block index is stored in 16 bits");
+
+	void Chunk::Set(const glm::ivec3& position, const Item& item)
 	{
+		Item previous = Get(position);
+		if (previous == item)
+			return;
+
+		SetBlock(position, item);
+		m_Modified = true;
+
+		if (!m_TrackingEdits)
+			return;
+
+		/// The first edit of a block remembers the generated one, edits restoring it cancel out
+		uint16_t index = GetChunkBlockIndex(position);
+		auto [edit, inserted] = m_Edits.try_emplace(index, ChunkEdit{ previous, item });
+		if (!inserted)
+		{
+			edit->second.Current = item;
+			if (edit->second.Current == edit->second.Original)
+				m_Edits.erase(edit);
+		}
+
+		/// Past the limit the chunk is cheaper to save whole
+		if (m_Edits.size() > ApplicationConfig::GetWorldData().ChunkDeltaMaxBlocks)
+		{
+			m_TrackingEdits = false;
+			m_Edits.clear();
+		}
+	}
+
+	std::shared_ptr<ChunkSaveSnapshot> Chunk::CreateSaveSnapshot(bool edits) const
+	{
+		auto snapshot = std::make_shared<ChunkSaveSnapshot>();
+		snapshot->Coord     = GetCoord();
+		snapshot->SaveEdits = edits && m_TrackingEdits;
+
+		if (snapshot->SaveEdits)
+		{
+			snapshot->Edits = m_Edits;
+		}
+		else
+		{
+			snapshot->ClimateMap = m_ClimateMap;
+			for (int i = 0; i < chunk_section_count; i++)
+				snapshot->Sections[i] = m_Sections[i];
+		}
+
+		return snapshot;
+	}
+
+	void Chunk::ApplyEdits()
+	{
+		for (auto it = m_Edits.begin(); it != m_Edits.end(); )
+		{
+			glm::ivec3 position = GetBlockPosition(it->first);
+			it->second.Original = Get(position);
+
+			if (it->second.Original == it->second.Current)
+			{
+				it = m_Edits.erase(it);
+				continue;
+			}
+
+			SetBlock(position, it->second.Current);
+			++it;
+		}
+	}
+
+	void Chunk::SetBlock(const glm::ivec3& position, const Item& item)
+	{
+		const Item air(ItemData::Air);
+
+		auto& section = m_Sections[position.y / chunk_section_size];
+		if (!section)
+		{
+			if (item == air)
+				return;
+
+			section = std::make_shared<PalettedContainer>(chunk_section_block_count, air);
+		}
+		else if (section.use_count() > 1)
+		{
+			/// A save snapshot still holds the section, it keeps the old blocks
+			section = std::make_shared<PalettedContainer>(*section);
+		}
+
+		section->Set(GetSectionBlockIndex(position), item);
+
+		if (section->IsUniform() && section->Get(0) == air)
+			section.reset();
+	}
+
+	size_t Chunk::GetBlocksMemoryUsage() const
+	{
+		size_t bytes = sizeof(m_Sections);
+		for (const auto& section : m_Sections)
+		{
+			if (section)
+				bytes += section->GetMemoryUsage();
+		}
+
+		return bytes;
 	}
 
 	void Chunk::Build()
 	{
+		/// Saved chunks are loaded instead of generated again, chunks saved as edits are generated with the edits placed over
+		ChunkLoadResult result = m_World ? m_World->GetChunkStorage().Load(this) : ChunkLoadResult::NotSaved;
+		if (result == ChunkLoadResult::Snapshot)
+		{
+			m_TrackingEdits = false;
+			return;
+		}
+
 		WorldGenerator::GenerateChunk(this);
 
-		bool hasMissingNeighbors =
-			(!GetLeftNeighbor() || !GetLeftNeighbor()->IsBuilded()) ||
-			(!GetRightNeighbor() || !GetRightNeighbor()->IsBuilded()) ||
-			(!GetFrontNeighbor() || !GetFrontNeighbor()->IsBuilded()) ||
-			(!GetBehindNeighbor() || !GetBehindNeighbor()->IsBuilded());
+		if (result == ChunkLoadResult::Edits)
+			ApplyEdits();
+		else
+			m_Modified = true;
+	}
 
-		SetMissingNeighborsStatus(hasMissingNeighbors);
+	void Chunk::OnBuildFinished()
+	{
 		m_Build = true;
+
+		if (m_State == ChunkState::Requested)
+			m_State = ChunkState::Generated;
 	}
 
-	void Chunk::Recreate()
+	bool Chunk::IsNeighborhoodGenerated() const
 	{
-		if (!IsBuilded())
-			return;
+		if (!m_Build)
+			return false;
+
+		for (Chunk* neighbor : m_Neighbors)
+		{
+			if (!neighbor || !neighbor->IsBuilded())
+				return false;
+		}
 
-		m_RendereData.Recreate();
-		m_Recreated = true;
+		return true;
 	}
 
-	Chunk* Chunk::GetLeftNeighbor() const
+	std::shared_ptr<ChunkMeshSnapshot> Chunk::CreateMeshSnapshot() const
 	{
-		return m_World->GetChunk({ m_Position.x - chunk_size_XZ, m_Position.y, m_Position.z });
+		if (!IsBuilded())
+			return nullptr;
+
+		auto snapshot = std::make_shared<ChunkMeshSnapshot>();
+		for (int i = 0; i < chunk_section_count; i++)
+		{
+			if (m_Sections[i])
+				m_Sections[i]->Unpack(snapshot->Data[i]);
+			else
+				std::fill(std::begin(snapshot->Data[i]), std::end(snapshot->Data[i]), Item(ItemData::Air));
+		}
+
+		Chunk* leftChunk   = GetLeftNeighbor();
+		Chunk* rightChunk  = GetRightNeighbor();
+		Chunk* frontChunk  = GetFrontNeighbor();
+		Chunk* behindChunk = GetBehindNeighbor();
+
+		snapshot->HasLeft   = leftChunk   && leftChunk  ->IsBuilded();
+		snapshot->HasRight  = rightChunk  && rightChunk ->IsBuilded();
+		snapshot->HasFront  = frontChunk  && frontChunk ->IsBuilded();
+		snapshot->HasBehind = behindChunk && behindChunk->IsBuilded();
+
+		for (int y = 0; y < chunk_size_Y; y++)
+		{
+			for (int i = 0; i < chunk_size_XZ; i++)
+			{
+				if (snapshot->HasLeft)
+					snapshot->Left[y][i]   = leftChunk  ->Get({ chunk_size_XZ - 1, y, i });
+				if (snapshot->HasRight)
+					snapshot->Right[y][i]  = rightChunk ->Get({ 0, y, i });
+				if (snapshot->HasFront)
+					snapshot->Front[y][i]  = frontChunk ->Get({ i, y, 0 });
+				if (snapshot->HasBehind)
+					snapshot->Behind[y][i] = behindChunk->Get({ i, y, chunk_size_XZ - 1 });
+			}
+		}
+
+		/// A section filled with one opaque block produces no faces if every side is covered by the same kind of section.
+		/// Missing neighbors and the bottom of the world never show faces, the top of the world always does.
+		auto isOpaqueUniform = [](const PalettedContainer* section) {
+			return section && section->IsUniform() && !ItemMenager::IsTransparent(section->Get(0).GetID());
+		};
+
+		for (int i = 0; i < chunk_section_count; i++)
+		{
+			const PalettedContainer* section = m_Sections[i].get();
+			if (!section)
+			{
+				snapshot->SkipSection[i] = true;
+				continue;
+			}
+
+			snapshot->SkipSection[i] = isOpaqueUniform(section) &&
+				(i < chunk_section_count - 1 && isOpaqueUniform(m_Sections[i + 1].get())) &&
+				(i == 0                      || isOpaqueUniform(m_Sections[i - 1].get())) &&
+				(!snapshot->HasLeft   || isOpaqueUniform(leftChunk  ->GetSection(i))) &&
+				(!snapshot->HasRight  || isOpaqueUniform(rightChunk ->GetSection(i))) &&
+				(!snapshot->HasFront  || isOpaqueUniform(frontChunk ->GetSection(i))) &&
+				(!snapshot->HasBehind || isOpaqueUniform(behindChunk->GetSection(i)));
+		}
+
+		snapshot->GreedyMeshing = ApplicationConfig::GetWorldData().GreedyMeshing;
+
+		return snapshot;
 	}
 
-	Chunk* Chunk::GetRightNeighbor() const
+	void Chunk::Recreate(const ChunkMeshSnapshot& snapshot)
 	{
-		return m_World->GetChunk({ m_Position.x + chunk_size_XZ, m_Position.y, m_Position.z });
+		m_RendereData.Recreate(snapshot);
 	}
 
-	Chunk* Chunk::GetFrontNeighbor() const
+	void Chunk::OnRecreateFinished()
 	{
-		return m_World->GetChunk({ m_Position.x, m_Position.y, m_Position.z + chunk_size_XZ });
+		m_RendereData.SwapBuffers();
+
+		if (m_State == ChunkState::Meshable)
+			m_State = ChunkState::Meshed;
 	}
 
-	Chunk* Chunk::GetBehindNeighbor() const
+	void Chunk::SetNeighbor(ChunkNeighbor neighbor, Chunk* chunk)
 	{
-		return m_World->GetChunk({ m_Position.x, m_Position.y, m_Position.z - chunk_size_XZ });
+		m_Neighbors[(uint8_t)neighbor] = chunk;
+
+		if (chunk)
+			chunk->m_Neighbors[(uint8_t)neighbor ^ 1] = this;
 	}
 
-	void Chunk::UpdateLastBuiltNeighbors()
+	void Chunk::UnlinkNeighbors()
 	{
-		m_LastLeftBuilt = (GetLeftNeighbor() && GetLeftNeighbor()->IsBuilded());
-		m_LastRightBuilt = (GetRightNeighbor() && GetRightNeighbor()->IsBuilded());
-		m_LastFrontBuilt = (GetFrontNeighbor() && GetFrontNeighbor()->IsBuilded());
-		m_LastBehindBuilt = (GetBehindNeighbor() && GetBehindNeighbor()->IsBuilded());
+		for (uint8_t i = 0; i < chunk_neighbor_count; i++)
+		{
+			if (m_Neighbors[i] && m_Neighbors[i]->m_Neighbors[i ^ 1] == this)
+				m_Neighbors[i]->m_Neighbors[i ^ 1] = nullptr;
+
+			m_Neighbors[i] = nullptr;
+		}
 	}
 }
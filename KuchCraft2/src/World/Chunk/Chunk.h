@@ -2,6 +2,7 @@
 
 #include "World/Item/Item.h"
 #include "World/Chunk/ChunkRenderData.h"
+#include "World/Chunk/PalettedContainer.h"
 
 namespace KuchCraft {
 
@@ -11,6 +12,104 @@ namespace KuchCraft {
 	/// The size of a chunk in the Y dimension.
 	inline constexpr int chunk_size_Y  = 256;
 
+	/// The number of blocks in a chunk.
+	inline constexpr int chunk_block_count = chunk_size_XZ * chunk_size_Y * chunk_size_XZ;
+
+	/// The height of a single chunk section.
+	inline constexpr int chunk_section_size = 16;
+
+	/// The number of sections stacked in a chunk.
+	inline constexpr int chunk_section_count = chunk_size_Y / chunk_section_size;
+
+	/// The number of blocks in a chunk section.
+	inline constexpr int chunk_section_block_count = chunk_size_XZ * chunk_section_size * chunk_size_XZ;
+
+	/// Horizontal neighbors of a chunk, opposite directions differ only in the lowest bit.
+	enum class ChunkNeighbor : uint8_t
+	{
+		Left   = 0,
+		Right  = 1,
+		Front  = 2,
+		Behind = 3
+	};
+
+	/// The number of horizontal neighbors of a chunk.
+	inline constexpr int chunk_neighbor_count = 4;
+
+	/// Chunk coordinate offsets of every neighbor, indexed by ChunkNeighbor.
+	inline constexpr glm::ivec2 chunk_neighbor_offsets[chunk_neighbor_count] = {
+		{ -1,  0 }, // Left
+		{  1,  0 }, // Right
+		{  0,  1 }, // Front
+		{  0, -1 }  // Behind
+	};
+
+	/// Stages of the chunk lifecycle, every chunk moves through them in order.
+	enum class ChunkState : uint8_t
+	{
+		/// Created and waiting to be filled with blocks by a worker thread.
+		Requested,
+
+		/// Filled with blocks, waiting for the rest of its neighbors.
+		Generated,
+
+		/// All neighbors are generated, queued to be meshed.
+		Meshable,
+
+		/// Mesh is built and the chunk is ready to render.
+		Meshed,
+
+		/// Removed from the world, deleted once worker threads are done with it.
+		Unloading
+	};
+
+	/// Biome and climate of every column of a chunk, kept after generation for gameplay queries.
+	/// Climate values are in [0, 1] and quantized to 8 bits, columns use [x][z] order.
+	struct ChunkClimateMap
+	{
+		std::array<uint8_t, chunk_size_XZ * chunk_size_XZ> BiomeIDs    = {};
+		std::array<uint8_t, chunk_size_XZ * chunk_size_XZ> Temperature = {};
+		std::array<uint8_t, chunk_size_XZ * chunk_size_XZ> Humidity    = {};
+		std::array<uint8_t, chunk_size_XZ * chunk_size_XZ> Vegetation  = {};
+
+		/// Converts a climate value to 8 bits, values outside [0, 1] are clamped.
+		static inline [[nodiscard]] uint8_t Quantize(float value) { return (uint8_t)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); }
+
+		/// Converts a quantized climate value back to [0, 1].
+		static inline [[nodiscard]] float Dequantize(uint8_t value) { return value / 255.0f; }
+	};
+
+	/// A block changed after the chunk was generated.
+	struct ChunkEdit
+	{
+		/// The block produced by the world generator.
+		Item Original;
+
+		/// The block placed over it.
+		Item Current;
+	};
+
+	/// Copy of everything needed to save a chunk, taken on the main thread so the chunk can be encoded
+	/// and written on the save thread while it keeps changing or after it is deleted.
+	struct ChunkSaveSnapshot
+	{
+		/// The chunk coordinate.
+		glm::ivec2 Coord = { 0, 0 };
+
+		/// Whether only the edits are saved, otherwise the whole chunk is.
+		bool SaveEdits = false;
+
+		/// Biome and climate of every column, set when the whole chunk is saved.
+		ChunkClimateMap ClimateMap;
+
+		/// Sections shared with the chunk, which copies a shared section before writing to it.
+		/// Set when the whole chunk is saved.
+		std::array<std::shared_ptr<const PalettedContainer>, chunk_section_count> Sections;
+
+		/// Blocks that differ from the generated terrain, set when only the edits are saved.
+		std::map<uint16_t, ChunkEdit> Edits;
+	};
+
 	class World;
 
 	class Chunk
@@ -23,60 +122,202 @@ namespace KuchCraft {
 
 		~Chunk();
 
-		/// Updates the chunk logic each frame.
-		/// @param dt Delta time since last frame.
-		void OnUpdate(float dt);
-
 		/// Fills the chunk with blocks.
+		/// Safe to call from a worker thread, the chunk is not visible as built until OnBuildFinished() is called.
 		void Build();
 
+		/// Marks the chunk as built and generated. Must be called on the main thread.
+		void OnBuildFinished();
+
 		/// Checks if the chunk has been built (filled with blocks).
 		/// @return True if built, false otherwise.
 		bool IsBuilded() const { return m_Build; }
 
+		/// Checks if the chunk is currently being filled with blocks on a worker thread.
+		/// Such chunk must not be deleted until the build is finished.
+		/// @return True if building, false otherwise.
+		bool IsBuilding() const { return m_Building; }
+
+		/// Sets whether the chunk was handed to a worker thread to be built.
+		/// @param status True if the build was scheduled, false once it has finished.
+		void SetBuilding(bool status) { m_Building = status; }
+
 		/// Checks if the chunk has been regenerated (is ready to render).
 		/// @return True if recreated, false otherwise.
-		bool IsRecreated() const { return m_Recreated; }
+		bool IsRecreated() const { return m_State == ChunkState::Meshed; }
+
+		/// Retrieves the stage of the chunk lifecycle.
+		ChunkState GetState() const { return m_State; }
+
+		/// Moves the chunk to another stage of its lifecycle. Must be called on the main thread.
+		/// @param state The new stage.
+		void SetState(ChunkState state) { m_State = state; }
+
+		/// Checks if the chunk and all of its neighbors are generated, so its mesh will not change when more chunks arrive.
+		/// @return True if the chunk can be meshed.
+		bool IsNeighborhoodGenerated() const;
+
+		/// Takes a snapshot of the chunk and its neighbors border slices for meshing. Must be called on the main thread.
+		/// @return The snapshot, or nullptr if the chunk is not built.
+		std::shared_ptr<ChunkMeshSnapshot> CreateMeshSnapshot() const;
+
+		/// Regenerates the chunk's mesh into the back buffer of the render data.
+		/// Safe to call from a worker thread, the mesh is not visible until OnRecreateFinished() is called.
+		/// @param snapshot The snapshot taken with CreateMeshSnapshot().
+		void Recreate(const ChunkMeshSnapshot& snapshot);
 
-		/// Regenerates the chunk's mesh.
-		void Recreate();
+		/// Publishes the rebuilt mesh. Must be called on the main thread.
+		void OnRecreateFinished();
+
+		/// Checks if the chunk mesh is currently being rebuilt on a worker thread.
+		/// Such chunk must not be deleted until meshing is finished.
+		/// @return True if meshing, false otherwise.
+		bool IsMeshing() const { return m_Meshing; }
+
+		/// Sets whether the chunk was handed to a worker thread to be meshed.
+		/// @param status True if meshing was scheduled, false once it has finished.
+		void SetMeshing(bool status) { m_Meshing = status; }
+
+		/// Checks if the chunk changed while it was meshed and needs another rebuild.
+		/// @return True if another rebuild is needed, false otherwise.
+		bool IsRecreatePending() const { return m_RecreatePending; }
+
+		/// Sets whether the chunk needs another rebuild once the running one is finished.
+		/// @param status True if another rebuild is needed.
+		void SetRecreatePending(bool status) { m_RecreatePending = status; }
 
 		/// Gets the left neighboring chunk.
 		/// @return Pointer to the left neighbor or nullptr if it doesn't exist
-		Chunk* GetLeftNeighbor() const;
+		Chunk* GetLeftNeighbor() const { return GetNeighbor(ChunkNeighbor::Left); }
 		
 		/// Gets the right neighboring chunk.
 		/// @return Pointer to the right neighbor or nullptr if it doesn't exist.
-		Chunk* GetRightNeighbor() const;
+		Chunk* GetRightNeighbor() const { return GetNeighbor(ChunkNeighbor::Right); }
 		
 		/// Gets the front neighboring chunk.
 		/// @return Pointer to the front neighbor or nullptr if it doesn't exist
-		Chunk* GetFrontNeighbor() const;
+		Chunk* GetFrontNeighbor() const { return GetNeighbor(ChunkNeighbor::Front); }
 		
 		/// Gets the behind neighboring chunk.
 		/// @return Pointer to the behind neighbor or nullptr if it doesn't exist.
-		Chunk* GetBehindNeighbor() const;
+		Chunk* GetBehindNeighbor() const { return GetNeighbor(ChunkNeighbor::Behind); }
+
+		/// Gets a neighboring chunk.
+		/// @param neighbor The direction of the neighbor.
+		/// @return Pointer to the neighbor or nullptr if it is not loaded.
+		Chunk* GetNeighbor(ChunkNeighbor neighbor) const { return m_Neighbors[(uint8_t)neighbor]; }
+
+		/// Links the chunk with a neighbor in both directions, nullptr clears the link on this side only.
+		/// Called by the ChunkGrid when chunks are inserted and removed.
+		/// @param neighbor The direction of the neighbor.
+		/// @param chunk The neighboring chunk.
+		void SetNeighbor(ChunkNeighbor neighbor, Chunk* chunk);
+
+		/// Clears links with every neighbor on both sides.
+		void UnlinkNeighbors();
 
 		/// Retrieves the chunk's render data.
 		/// @return Reference to the chunk's render data.
 		const ChunkRenderData& GetRenderData() const { return m_RendereData; }
 
-		/// Checks if any neighboring chunk is missing.
-		/// @return True if any neighbor is missing, false otherwise.
-		bool GetMissingNeighborsStatus() const { return m_MissingNeighbors; }
+		/// Retrieves the chunk's render data.
+		/// @return Reference to the chunk's render data.
+		ChunkRenderData& GetRenderData() { return m_RendereData; }
 
-		/// Sets the missing neighbor status of the chunk.
-		/// @param status True if a neighbor is missing, false otherwise.
-		void SetMissingNeighborsStatus(bool status) { m_MissingNeighbors = status; }
 
 		/// Retrieves the position of the chunk in the world.
 		/// @return The position of the chunk.
 		inline [[nodiscard]] glm::vec3 GetPosition() const { return m_Position; }
 
+		/// Retrieves the coordinate of the chunk in chunk units.
+		/// @return The position of the chunk divided by chunk_size_XZ, x and z only.
+		inline [[nodiscard]] glm::ivec2 GetCoord() const { return { m_Position.x / chunk_size_XZ, m_Position.z / chunk_size_XZ }; }
+
 		/// Retrieves an item at a specific position within the chunk.
 		/// @param position The local position within the chunk.
 		/// @return The item at the specified position.
-		inline [[nodiscard]] Item Get(const glm::ivec3& position) const { return m_Data[position.x][position.y][position.z]; }
+		inline [[nodiscard]] Item Get(const glm::ivec3& position) const
+		{
+			const auto& section = m_Sections[position.y / chunk_section_size];
+			return section ? section->Get(GetSectionBlockIndex(position)) : Item(ItemData::Air);
+		}
+
+		/// Sets an item at a specific position within the chunk, marks the chunk as modified and records the edit.
+		/// Allocates the section on the first non-air block and releases it once it holds only air.
+		/// @param position The local position within the chunk.
+		/// @param item The item to place.
+		void Set(const glm::ivec3& position, const Item& item);
+
+		/// Checks if the blocks differ from the ones saved on disk, chunks that were never saved count as modified.
+		inline [[nodiscard]] bool IsModified() const { return m_Modified; }
+
+		/// Sets whether the blocks differ from the ones saved on disk.
+		/// @param status False once the chunk is saved.
+		void SetModified(bool status) { m_Modified = status; }
+
+		/// Checks if the chunk can be described as its edits over the generated terrain.
+		/// Chunks loaded from a full snapshot or with too many edits can only be saved whole.
+		inline [[nodiscard]] bool IsTrackingEdits() const { return m_TrackingEdits; }
+
+		/// Retrieves blocks that differ from the generated terrain, indexed by GetChunkBlockIndex().
+		inline [[nodiscard]] const std::map<uint16_t, ChunkEdit>& GetEdits() const { return m_Edits; }
+
+		/// Takes a snapshot of the chunk for saving. Must be called on the main thread.
+		/// Sections are shared, not copied, so the snapshot is cheap.
+		/// @param edits - whether only the edits are saved when the chunk tracks them.
+		/// @return The snapshot.
+		std::shared_ptr<ChunkSaveSnapshot> CreateSaveSnapshot(bool edits) const;
+
+		/// Places recorded edits over freshly generated terrain, the generated blocks become their originals.
+		/// Called after a chunk saved as edits was generated again.
+		void ApplyEdits();
+
+		/// Retrieves the biome of a column.
+		/// @param x, z The local column position within the chunk.
+		inline [[nodiscard]] int GetBiomeID(int x, int z) const { return m_ClimateMap.BiomeIDs[x * chunk_size_XZ + z]; }
+
+		/// Retrieves the temperature of a column in [0, 1].
+		/// @param x, z The local column position within the chunk.
+		inline [[nodiscard]] float GetTemperature(int x, int z) const { return ChunkClimateMap::Dequantize(m_ClimateMap.Temperature[x * chunk_size_XZ + z]); }
+
+		/// Retrieves the humidity of a column in [0, 1].
+		/// @param x, z The local column position within the chunk.
+		inline [[nodiscard]] float GetHumidity(int x, int z) const { return ChunkClimateMap::Dequantize(m_ClimateMap.Humidity[x * chunk_size_XZ + z]); }
+
+		/// Retrieves the vegetation density of a column in [0, 1].
+		/// @param x, z The local column position within the chunk.
+		inline [[nodiscard]] float GetVegetation(int x, int z) const { return ChunkClimateMap::Dequantize(m_ClimateMap.Vegetation[x * chunk_size_XZ + z]); }
+
+		/// Retrieves the block storage of a section.
+		/// @param index The section index, counted from the bottom of the chunk.
+		/// @return Pointer to the section storage, or nullptr if the section holds only air.
+		inline [[nodiscard]] const PalettedContainer* GetSection(int index) const { return m_Sections[index].get(); }
+
+		/// Retrieves the approximate number of bytes used by the block storage of all sections.
+		[[nodiscard]] size_t GetBlocksMemoryUsage() const;
+
+		/// Calculates the index of a block inside its section, sections use [x][y][z] order.
+		/// @param position The local position within the chunk.
+		/// @return The index of the block in the section.
+		inline [[nodiscard]] static constexpr uint32_t GetSectionBlockIndex(const glm::ivec3& position) {
+			return (uint32_t)((position.x * chunk_section_size + position.y % chunk_section_size) * chunk_size_XZ + position.z);
+		}
+
+		/// Calculates the index of a block in the whole chunk, sections follow each other from the bottom.
+		/// @param position The local position within the chunk.
+		inline [[nodiscard]] static constexpr uint16_t GetChunkBlockIndex(const glm::ivec3& position) {
+			return (uint16_t)(position.y / chunk_section_size * chunk_section_block_count + GetSectionBlockIndex(position));
+		}
+
+		/// Calculates the local position of a block from its index in the whole chunk.
+		/// @param index The index returned by GetChunkBlockIndex().
+		inline [[nodiscard]] static constexpr glm::ivec3 GetBlockPosition(uint16_t index) {
+			uint32_t block = index % chunk_section_block_count;
+			return { (int)(block / (chunk_section_size * chunk_size_XZ)),
+					 (int)(index / chunk_section_block_count * chunk_section_size + block / chunk_size_XZ % chunk_section_size),
+					 (int)(block % chunk_size_XZ)
+			};
+		}
 
 		/// Retrieves an item at a specific position within the chunk safely.
 		/// @param position The local position within the chunk.
@@ -89,7 +330,7 @@ namespace KuchCraft {
 			{
 				return Item(ItemData::Air);
 			}
-			return m_Data[position.x][position.y][position.z];
+			return Get(position);
 		}
 
 		/// Calculates the origin position of a chunk given a world position.
@@ -102,84 +343,117 @@ namespace KuchCraft {
 			};
 		}
 
-		/// Checks if the left neighbor was built in the previous update.
-		/// @return True if left neighbor was built, false otherwise.
-		bool GetLastLeftBuilt() const { return m_LastLeftBuilt; }
-
-		/// Checks if the right neighbor was built in the previous update.
-		/// @return True if right neighbor was built, false otherwise.
-		bool GetLastRightBuilt() const { return m_LastRightBuilt; }
-
-		/// Checks if the front neighbor was built in the previous update.
-		/// @return True if front neighbor was built, false otherwise.
-		bool GetLastFrontBuilt() const { return m_LastFrontBuilt; }
-
-		/// Checks if the behind neighbor was built in the previous update.
-		/// @return True if behind neighbor was built, false otherwise.
-		bool GetLastBehindBuilt() const { return m_LastBehindBuilt; }
-
-		/// Sets the state of the left neighbor from the previous update.
-		/// @param status True if the left neighbor was built, false otherwise.
-		void SetLastLeftBuilt(bool status) { m_LastLeftBuilt = status; }
-
-		/// Sets the state of the right neighbor from the previous update.
-		/// @param status True if the right neighbor was built, false otherwise.
-		void SetLastRightBuilt(bool status) { m_LastRightBuilt = status;}
-
-		/// Sets the state of the front neighbor from the previous update.
-		/// @param status True if the front neighbor was built, false otherwise.
-		void SetLastFrontBuilt(bool status) { m_LastFrontBuilt = status; }
-
-		/// Sets the state of the behind neighbor from the previous update.
-		/// @param status True if the behind neighbor was built, false otherwise.
-		void SetLastBehindBuilt(bool status) { m_LastBehindBuilt = status; }
-
-		/// Updates the stored state of neighboring chunks.
-		void UpdateLastBuiltNeighbors();
 		
 	private:
-		/// Whether the chunk has been regenerated. (chunk mesh is ready to render)
-		bool m_Recreated = false;
+		/// Writes a block without recording it as an edit.
+		void SetBlock(const glm::ivec3& position, const Item& item);
+
+	private:
+		/// The stage of the chunk lifecycle.
+		ChunkState m_State = ChunkState::Requested;
 
 		/// Whether the chunk has been built. (filed with blocks)
 		bool m_Build = false;
 
-		/// Whether the chunk has missing neighbors.
-		bool m_MissingNeighbors = true;
+		/// Whether the chunk is being built on a worker thread.
+		bool m_Building = false;
+
+		/// Whether the chunk mesh is being rebuilt on a worker thread.
+		bool m_Meshing = false;
 
-		/// Whether the left neighbor was built in the last update.
-		bool m_LastLeftBuilt = false;
+		/// Whether the chunk needs another rebuild after the running one.
+		bool m_RecreatePending = false;
 
-		/// Whether the right neighbor was built in the last update.
-		bool m_LastRightBuilt = false;
+		/// Whether the blocks differ from the ones saved on disk.
+		bool m_Modified = false;
 
-		/// Whether the front neighbor was built in the last update.
-		bool m_LastFrontBuilt = false;
+		/// Whether edits are recorded in m_Edits.
+		bool m_TrackingEdits = true;
 
-		/// Whether the behind neighbor was built in the last update.
-		bool m_LastBehindBuilt = false;
 
 		/// The integer position of the chunk in world coordinates.
 		const glm::ivec3 m_Position = { 0, 0, 0 };
 
+		/// Loaded neighboring chunks indexed by ChunkNeighbor, nullptr if not loaded.
+		std::array<Chunk*, chunk_neighbor_count> m_Neighbors = {};
+
 		/// A pointer to the world that owns this chunk.
 		World* m_World = nullptr;
 
 		/// The render data for this chunk.
 		friend class ChunkRenderData;
 		friend class WorldGenerator;
+		friend class ChunkSerializer;
 		ChunkRenderData m_RendereData;
-		std::array<int,   chunk_size_XZ* chunk_size_XZ>  m_BiomesIDs;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_Continentalness;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_PeaksAndValies;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_Temperature;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_Humidity;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_Vegetation;
-		std::array<float, chunk_size_XZ * chunk_size_XZ> m_Erosion;
 
-		/// A 3D array storing items within the chunk.
-		Item m_Data[chunk_size_XZ][chunk_size_Y][chunk_size_XZ];
+		/// Biome and climate of every column, written by the world generator.
+		ChunkClimateMap m_ClimateMap;
+
+		/// Palette compressed items within the chunk split into vertical sections, nullptr means only air.
+		/// Sections holding a single item use no index storage at all.
+		/// Sections can be shared with save snapshots and are copied on write.
+		std::array<std::shared_ptr<PalettedContainer>, chunk_section_count> m_Sections;
+
+		/// Blocks changed since the chunk was generated, sorted by GetChunkBlockIndex() so they encode into runs.
+		std::map<uint16_t, ChunkEdit> m_Edits;
+
+	};
+
+	/// Immutable copy of everything needed to mesh a chunk, so meshing can run on a worker thread
+	/// while the chunk and its neighbors keep changing on the main thread.
+	struct ChunkMeshSnapshot
+	{
+		/// Copy of the chunk blocks, empty sections are filled with air.
+		Item Data[chunk_section_count][chunk_section_block_count];
+
+		/// Border slice of the left neighbor (x = chunk_size_XZ - 1), indexed by [y][z].
+		Item Left[chunk_size_Y][chunk_size_XZ];
+
+		/// Border slice of the right neighbor (x = 0), indexed by [y][z].
+		Item Right[chunk_size_Y][chunk_size_XZ];
+
+		/// Border slice of the front neighbor (z = 0), indexed by [y][x].
+		Item Front[chunk_size_Y][chunk_size_XZ];
 
+		/// Border slice of the behind neighbor (z = chunk_size_XZ - 1), indexed by [y][x].
+		Item Behind[chunk_size_Y][chunk_size_XZ];
+
+		/// Whether the neighbor was built when the snapshot was taken, missing neighbors hide border faces.
+		bool HasLeft   = false;
+		bool HasRight  = false;
+		bool HasFront  = false;
+		bool HasBehind = false;
+
+		/// Sections that can not produce any face, either empty or enclosed by opaque blocks on every side.
+		bool SkipSection[chunk_section_count] = {};
+
+		/// Whether the mesh should be built with greedy meshing, read from the configuration on the main thread.
+		bool GreedyMeshing = true;
+
+		/// Retrieves a copied block.
+		/// @param x, y, z The local position within the chunk.
+		inline [[nodiscard]] const Item& Get(int x, int y, int z) const
+		{
+			return Data[y / chunk_section_size][Chunk::GetSectionBlockIndex({ x, y, z })];
+		}
+	};
+
+	/// The number of 64-bit words holding one bit per block of a chunk column.
+	inline constexpr int chunk_column_words = chunk_size_Y / 64;
+
+	/// Visible faces of a chunk stored as one bit per block (bit y) for every face and column.
+	struct ChunkFaceMasks
+	{
+		uint64_t Columns[block_face_count][chunk_size_XZ][chunk_size_XZ][chunk_column_words];
+
+		/// Checks if a face of a block is visible.
+		/// @param face The face to check.
+		/// @param x, y, z The local position within the chunk.
+		inline [[nodiscard]] bool IsVisible(BlockFaces face, int x, int y, int z) const
+		{
+			return (Columns[(uint32_t)face][x][z][y >> 6] >> (y & 63)) & 1;
+		}
 	};
 
+
 }
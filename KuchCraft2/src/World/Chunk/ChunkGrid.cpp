@@ -0,0 +1,92 @@
+///
+/// @file ChunkGrid.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/ChunkGrid.h"
+
+namespace KuchCraft {
+
+	bool ChunkGrid::Insert(Chunk* chunk)
+	{
+		if (m_Slots.empty() || !Contains(chunk->GetCoord()))
+			return false;
+
+		Chunk*& slot = m_Slots[GetSlotIndex(chunk->GetCoord())];
+		if (slot)
+			return false;
+
+		slot = chunk;
+		m_Count++;
+
+		for (uint8_t i = 0; i < chunk_neighbor_count; i++)
+			chunk->SetNeighbor((ChunkNeighbor)i, Get(chunk->GetCoord() + chunk_neighbor_offsets[i]));
+
+		return true;
+	}
+
+	void ChunkGrid::SetCenter(const glm::ivec2& center, std::vector<Chunk*>& evicted)
+	{
+		if (center == m_Center)
+			return;
+
+		glm::ivec2 previousCenter = m_Center;
+		m_Center = center;
+
+		if (m_Slots.empty())
+			return;
+
+		/// Only the part of the previous window that is not covered by the new one can hold chunks to remove
+		ForEachInDiscDifference(previousCenter, (int)m_Radius, center, (int)m_Radius, [&](const glm::ivec2& coord) {
+			Chunk*& slot = m_Slots[GetSlotIndex(coord)];
+			if (slot && slot->GetCoord() == coord)
+			{
+				slot->UnlinkNeighbors();
+				evicted.push_back(slot);
+				slot = nullptr;
+				m_Count--;
+			}
+		});
+	}
+
+	void ChunkGrid::Resize(uint32_t radius, std::vector<Chunk*>& evicted)
+	{
+		if (radius == m_Radius && !m_Slots.empty())
+			return;
+
+		std::vector<Chunk*> slots = std::move(m_Slots);
+
+		m_Radius = radius;
+		m_Side   = 2 * (int)radius + 1;
+		m_Count  = 0;
+		m_Slots.assign((size_t)m_Side * m_Side, nullptr);
+
+		/// Slots depend on the side length, so every kept chunk has to be placed again
+		for (Chunk* chunk : slots)
+		{
+			if (chunk && !Insert(chunk))
+			{
+				chunk->UnlinkNeighbors();
+				evicted.push_back(chunk);
+			}
+		}
+	}
+
+	void ChunkGrid::Clear(std::vector<Chunk*>& evicted)
+	{
+		for (Chunk*& slot : m_Slots)
+		{
+			if (slot)
+			{
+				slot->UnlinkNeighbors();
+				evicted.push_back(slot);
+				slot = nullptr;
+			}
+		}
+
+		m_Count = 0;
+	}
+
+}
@@ -0,0 +1,192 @@
+///
+/// @file ChunkGrid.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkGrid class, a fixed size circular window
+///        of loaded chunks centered on the player.
+///
+/// @details Chunks are addressed by integer chunk coordinates (world position / chunk_size_XZ).
+///          The window holds every coordinate within the radius of the center and is stored in a square
+///          of side 2 * radius + 1. Every coordinate maps to the slot (x mod side, z mod side), so the window
+///          moves with the player without moving any chunk in memory, chunks that leave the window are handed
+///          back to the caller and their slots are reused for coordinates entering on the opposite side.
+///          Moving the window only visits the coordinates that left it.
+///          Chunks stored in the grid are linked with their neighbors, removed chunks are unlinked.
+///
+/// @thread_safety Not thread-safe, must be used from the main thread only.
+///
+
+#pragma once
+
+#include "World/Chunk/Chunk.h"
+
+namespace KuchCraft {
+
+	class ChunkGrid
+	{
+	public:
+		ChunkGrid() = default;
+
+		~ChunkGrid() = default;
+
+		/// Converts a world position to the coordinate of the chunk containing it.
+		/// @param position - the position in the world.
+		/// @return The chunk coordinate, x and z of the world divided by chunk_size_XZ.
+		static inline [[nodiscard]] glm::ivec2 GetChunkCoord(const glm::vec3& position)
+		{
+			return { (int)std::floor(position.x / chunk_size_XZ), (int)std::floor(position.z / chunk_size_XZ) };
+		}
+
+		/// Calls a function for every coordinate of a disc that is not inside another disc.
+		/// Both discs are walked row by row, so the cost depends on the number of visited coordinates
+		/// and the number of rows, not on the area of the discs.
+		/// @param center - the center of the visited disc.
+		/// @param radius - the radius of the visited disc, coordinates at distance <= radius belong to it.
+		/// @param excludedCenter - the center of the excluded disc.
+		/// @param excludedRadius - the radius of the excluded disc, negative if nothing is excluded.
+		/// @param function - callable taking const glm::ivec2&.
+		template<typename Function>
+		static void ForEachInDiscDifference(const glm::ivec2& center, int radius, const glm::ivec2& excludedCenter, int excludedRadius, Function&& function)
+		{
+			for (int z = center.y - radius; z <= center.y + radius; z++)
+			{
+				int halfWidth = GetDiscHalfWidth(radius, z - center.y);
+				int begin     = center.x - halfWidth;
+				int end       = center.x + halfWidth;
+
+				/// Row of the excluded disc, empty if the row is outside of it
+				int excludedBegin = 1;
+				int excludedEnd   = 0;
+				if (excludedRadius >= 0 && std::abs(z - excludedCenter.y) <= excludedRadius)
+				{
+					int excludedHalfWidth = GetDiscHalfWidth(excludedRadius, z - excludedCenter.y);
+					excludedBegin = excludedCenter.x - excludedHalfWidth;
+					excludedEnd   = excludedCenter.x + excludedHalfWidth;
+				}
+
+				if (excludedBegin > excludedEnd)
+				{
+					for (int x = begin; x <= end; x++)
+						function(glm::ivec2(x, z));
+					continue;
+				}
+
+				for (int x = begin; x <= std::min(end, excludedBegin - 1); x++)
+					function(glm::ivec2(x, z));
+
+				for (int x = std::max(begin, excludedEnd + 1); x <= end; x++)
+					function(glm::ivec2(x, z));
+			}
+		}
+
+		/// Retrieves a chunk.
+		/// @param coord - the chunk coordinate.
+		/// @return The chunk, or nullptr if it is not loaded or outside the window.
+		inline [[nodiscard]] Chunk* Get(const glm::ivec2& coord) const
+		{
+			if (m_Slots.empty())
+				return nullptr;
+
+			Chunk* chunk = m_Slots[GetSlotIndex(coord)];
+			return chunk && chunk->GetCoord() == coord ? chunk : nullptr;
+		}
+
+		/// Stores a chunk in the slot of its coordinate and links it with its loaded neighbors.
+		/// @param chunk - the chunk, its coordinate has to be inside the window and its slot empty.
+		/// @return True if stored, false if the coordinate is outside the window or the slot is taken.
+		bool Insert(Chunk* chunk);
+
+		/// Checks if a chunk coordinate is inside the window.
+		inline [[nodiscard]] bool Contains(const glm::ivec2& coord) const
+		{
+			glm::ivec2 offset = coord - m_Center;
+			return offset.x * offset.x + offset.y * offset.y <= (int)(m_Radius * m_Radius);
+		}
+
+		/// Moves the window, chunks left outside are removed from the grid.
+		/// @param center - the chunk coordinate of the new center.
+		/// @param evicted - the vector removed chunks are appended to, the caller becomes their owner.
+		void SetCenter(const glm::ivec2& center, std::vector<Chunk*>& evicted);
+
+		/// Changes the size of the window, chunks still inside it are kept.
+		/// @param radius - the number of chunks between the center and the edge of the window.
+		/// @param evicted - the vector removed chunks are appended to, the caller becomes their owner.
+		void Resize(uint32_t radius, std::vector<Chunk*>& evicted);
+
+		/// Removes every chunk from the grid.
+		/// @param evicted - the vector removed chunks are appended to, the caller becomes their owner.
+		void Clear(std::vector<Chunk*>& evicted);
+
+		/// Calls a function for every stored chunk.
+		/// @param function - callable taking Chunk*.
+		template<typename Function>
+		void ForEach(Function&& function) const
+		{
+			for (Chunk* chunk : m_Slots)
+			{
+				if (chunk)
+					function(chunk);
+			}
+		}
+
+		/// Retrieves the number of stored chunks.
+		inline [[nodiscard]] uint32_t GetCount() const { return m_Count; }
+
+		/// Retrieves the number of slots.
+		inline [[nodiscard]] uint32_t GetCapacity() const { return (uint32_t)m_Slots.size(); }
+
+		/// Retrieves the number of chunks between the center and the edge of the window.
+		inline [[nodiscard]] uint32_t GetRadius() const { return m_Radius; }
+
+		/// Retrieves the chunk coordinate of the window center.
+		inline [[nodiscard]] const glm::ivec2& GetCenter() const { return m_Center; }
+
+	private:
+		/// Retrieves the largest x offset of a disc row.
+		/// @param radius - the radius of the disc.
+		/// @param z - the offset of the row from the disc center, |z| <= radius.
+		static inline [[nodiscard]] int GetDiscHalfWidth(int radius, int z)
+		{
+			int squared   = radius * radius - z * z;
+			int halfWidth = (int)std::sqrt((float)squared);
+
+			/// Correct rounding errors of the float square root
+			while ((halfWidth + 1) * (halfWidth + 1) <= squared)
+				halfWidth++;
+			while (halfWidth * halfWidth > squared)
+				halfWidth--;
+
+			return halfWidth;
+		}
+
+		/// Maps a chunk coordinate to its slot, wrapping around the edges of the storage.
+		inline [[nodiscard]] uint32_t GetSlotIndex(const glm::ivec2& coord) const
+		{
+			int x = coord.x % m_Side;
+			int z = coord.y % m_Side;
+			if (x < 0) x += m_Side;
+			if (z < 0) z += m_Side;
+
+			return (uint32_t)(z * m_Side + x);
+		}
+
+	private:
+		/// Chunks stored by wrapped coordinate, nullptr marks an empty slot.
+		std::vector<Chunk*> m_Slots;
+
+		/// Number of non empty slots.
+		uint32_t m_Count = 0;
+
+		/// Number of chunks between the center and the edge of the window.
+		uint32_t m_Radius = 0;
+
+		/// Length of the window side, 2 * radius + 1.
+		int m_Side = 0;
+
+		/// Chunk coordinate of the window center.
+		glm::ivec2 m_Center = { 0, 0 };
+
+	};
+
+}
@@ -0,0 +1,97 @@
+///
+/// @file ChunkPool.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/ChunkPool.h"
+
+#ifdef __linux__
+	#include <sys/mman.h>
+#endif
+
+#ifdef  INCLUDE_IMGUI
+	#include <imgui.h>
+#endif
+
+namespace KuchCraft {
+
+	/// Slabs match the size and alignment of a huge page, so a single slab can be backed by one
+	constexpr size_t chunk_pool_slab_size = 2 * 1024 * 1024;
+
+	ChunkPool::~ChunkPool()
+	{
+		if (m_LiveCount > 0)
+			Log::Error("[Chunk Pool] : {} chunks were not destroyed before the pool", m_LiveCount);
+
+		for (void* slab : m_Slabs)
+			::operator delete(slab, std::align_val_t(chunk_pool_slab_size));
+	}
+
+	Chunk* ChunkPool::Create(World* world, const glm::vec3& position)
+	{
+		if (m_FreeSlots.empty())
+		{
+			AllocateSlab();
+			m_Misses++;
+		}
+		else
+			m_Hits++;
+
+		Chunk* slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+		m_LiveCount++;
+
+		return new (slot) Chunk(world, position);
+	}
+
+	void ChunkPool::Destroy(Chunk* chunk)
+	{
+		if (!chunk)
+			return;
+
+		chunk->~Chunk();
+		m_FreeSlots.push_back(chunk);
+		m_LiveCount--;
+	}
+
+	void ChunkPool::Reserve(uint32_t capacity, bool hugePages)
+	{
+		m_UseHugePages = hugePages;
+
+		while (GetCapacity() < capacity)
+			AllocateSlab();
+	}
+
+	void ChunkPool::AllocateSlab()
+	{
+		if (m_ChunksPerSlab == 0)
+		{
+			m_ChunksPerSlab = std::max<uint32_t>((uint32_t)(chunk_pool_slab_size / sizeof(Chunk)), 1);
+			m_SlabSize      = std::max<size_t>(chunk_pool_slab_size, (size_t)m_ChunksPerSlab * sizeof(Chunk));
+		}
+
+		void* slab = ::operator new(m_SlabSize, std::align_val_t(chunk_pool_slab_size));
+		m_Slabs.push_back(slab);
+
+#ifdef __linux__
+		if (m_UseHugePages && madvise(slab, m_SlabSize, MADV_HUGEPAGE) == 0)
+			m_HugePageSlabs++;
+#endif
+
+		/// Slots are pushed in reverse, so chunks fill a slab from its beginning
+		Chunk* slots = static_cast<Chunk*>(slab);
+		for (uint32_t i = m_ChunksPerSlab; i > 0; i--)
+			m_FreeSlots.push_back(slots + (i - 1));
+	}
+
+	void ChunkPool::RenderImGui() const
+	{
+#ifdef  INCLUDE_IMGUI
+		ImGui::Text("Chunk pool: %u / %u chunks, %u slabs (%u huge pages)", m_LiveCount, GetCapacity(), (uint32_t)m_Slabs.size(), m_HugePageSlabs);
+		ImGui::Text("Chunk pool hit rate: %.1f%%, resident memory: %.2f MiB", GetHitRate() * 100.0f, GetResidentMemory() / (1024.0f * 1024.0f));
+#endif
+	}
+
+}
@@ -0,0 +1,95 @@
+///
+/// @file ChunkPool.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkPool class, a slab allocator
+///        recycling the storage of chunks.
+///
+/// @details Chunk storage is taken from large slabs holding many chunks at once. Destroyed chunks return
+///          their slot to a free list and the next created chunk reuses it, so moving around the world
+///          does not allocate or release chunk memory. Slabs are only released with the pool.
+///          On Linux slabs can be backed by transparent huge pages to reduce page faults and TLB misses.
+///
+/// @thread_safety Not thread-safe, must be used from the main thread only.
+///
+
+#pragma once
+
+#include "World/Chunk/Chunk.h"
+
+namespace KuchCraft {
+
+	class ChunkPool
+	{
+	public:
+		ChunkPool() = default;
+
+		~ChunkPool();
+
+		ChunkPool(const ChunkPool&) = delete;
+		ChunkPool& operator=(const ChunkPool&) = delete;
+
+		/// Creates a chunk in a free slot, a new slab is allocated if there is none.
+		/// @param world - the world that owns the chunk.
+		/// @param position - a world position inside the chunk.
+		/// @return The created chunk.
+		[[nodiscard]] Chunk* Create(World* world, const glm::vec3& position);
+
+		/// Destroys a chunk created by this pool and makes its slot free.
+		void Destroy(Chunk* chunk);
+
+		/// Allocates slabs until the pool can hold the given number of chunks.
+		/// @param capacity - the number of chunks.
+		/// @param hugePages - whether this and later slabs ask the system for huge pages.
+		void Reserve(uint32_t capacity, bool hugePages);
+
+		/// Retrieves the number of chunks the allocated slabs can hold.
+		inline [[nodiscard]] uint32_t GetCapacity() const { return (uint32_t)m_Slabs.size() * m_ChunksPerSlab; }
+
+		/// Retrieves the number of live chunks.
+		inline [[nodiscard]] uint32_t GetLiveCount() const { return m_LiveCount; }
+
+		/// Retrieves the memory held by the slabs in bytes.
+		inline [[nodiscard]] size_t GetResidentMemory() const { return m_Slabs.size() * m_SlabSize; }
+
+		/// Retrieves the fraction of created chunks that got a slot without allocating a new slab.
+		inline [[nodiscard]] float GetHitRate() const { return m_Hits + m_Misses > 0 ? (float)m_Hits / (float)(m_Hits + m_Misses) : 1.0f; }
+
+		/// Retrieves the number of slabs backed by huge pages.
+		inline [[nodiscard]] uint32_t GetHugePageSlabCount() const { return m_HugePageSlabs; }
+
+		/// Renders the pool stats.
+		void RenderImGui() const;
+
+	private:
+		/// Allocates a slab and puts its slots on the free list.
+		void AllocateSlab();
+
+	private:
+		/// Allocated slabs.
+		std::vector<void*> m_Slabs;
+
+		/// Slots ready to be used, the most recently freed slot is reused first while it is still in cache.
+		std::vector<Chunk*> m_FreeSlots;
+
+		/// Size of a slab in bytes and the number of chunks it holds.
+		size_t   m_SlabSize      = 0;
+		uint32_t m_ChunksPerSlab = 0;
+
+		/// Number of live chunks.
+		uint32_t m_LiveCount = 0;
+
+		/// Whether new slabs ask the system for huge pages.
+		bool m_UseHugePages = false;
+
+		/// Number of slabs backed by huge pages.
+		uint32_t m_HugePageSlabs = 0;
+
+		/// Chunks created from a free slot and chunks that needed a new slab.
+		uint64_t m_Hits   = 0;
+		uint64_t m_Misses = 0;
+
+	};
+
+}
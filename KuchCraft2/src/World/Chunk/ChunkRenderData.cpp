@@ -5,6 +5,8 @@
 #include "World/Chunk/Chunk.h"
 #include "World/Item/ItemMenager.h"
 
+#include "Graphics/Renderer.h"
+
 namespace KuchCraft
 {
 
@@ -15,78 +17,319 @@ namespace KuchCraft
 
 	ChunkRenderData::~ChunkRenderData()
 	{
+		Renderer::ReleaseChunkMesh(m_Allocation);
 	}
 
-    void ChunkRenderData::Recreate()
+    void ChunkRenderData::Recreate(const ChunkMeshSnapshot& snapshot)
     {
-        if (!m_Chunk->IsBuilded())
-            return;
+        m_BackData.clear();
 
-        m_Data.clear();
-        m_Data.reserve(chunk_size_XZ * chunk_size_XZ * chunk_size_Y * block_vertex_count);
+        if (snapshot.GreedyMeshing)
+            BuildGreedyMesh(snapshot, m_BackData);
+        else
+            BuildMesh(snapshot, m_BackData);
+
+        m_BackData.shrink_to_fit();
+    }
 
-        glm::ivec3 position    = m_Chunk->GetPosition();
-        Chunk*     leftChunk   = m_Chunk->GetLeftNeighbor();
-        Chunk*     rightChunk  = m_Chunk->GetRightNeighbor();
-        Chunk*     frontChunk  = m_Chunk->GetFrontNeighbor();
-        Chunk*     behindChunk = m_Chunk->GetBehindNeighbor();
+    void ChunkRenderData::BuildMesh(const ChunkMeshSnapshot& snapshot, std::vector<uint32_t>& output)
+    {
+        auto masks = std::make_unique<ChunkFaceMasks>();
+        FindVisibleFaces(snapshot, *masks);
 
-        for (int x = 0; x < chunk_size_XZ; x++)
+        for (uint8_t face = 0; face < block_face_count; face++)
         {
-            for (int y = 0; y < chunk_size_Y; y++)
+            for (int x = 0; x < chunk_size_XZ; x++)
             {
                 for (int z = 0; z < chunk_size_XZ; z++)
                 {
-                    const Item& block = m_Chunk->m_Data[x][y][z];
-                    if (block.GetID() == (ItemID)ItemData::Air)
-                        continue;
-
-                    bool hasFrontChunk  = (frontChunk  && frontChunk ->IsBuilded());
-                    bool hasBehindChunk = (behindChunk && behindChunk->IsBuilded());
-                    bool hasRightChunk  = (rightChunk  && rightChunk ->IsBuilded());
-                    bool hasLeftChunk   = (leftChunk   && leftChunk  ->IsBuilded());
-
-                    bool renderBottom = (y > 0) && ItemMenager::GetInfo(m_Chunk->Get({ x, y - 1, z }).GetID()).Transparent;
-
-                    bool renderTop = (y == chunk_size_Y - 1) || ItemMenager::GetInfo(m_Chunk->Get({ x, y + 1, z }).GetID()).Transparent;
-
-                    bool renderFront = (z == chunk_size_XZ - 1) ?
-                        (hasFrontChunk && ItemMenager::GetInfo(frontChunk->Get({ x, y, 0 }).GetID()).Transparent)
-                        : ItemMenager::GetInfo(m_Chunk->Get({ x, y, z + 1 }).GetID()).Transparent;
-
-                    bool renderBehind = (z == 0) ?
-                        (hasBehindChunk && ItemMenager::GetInfo(behindChunk->Get({ x, y, chunk_size_XZ - 1 }).GetID()).Transparent)
-                        : ItemMenager::GetInfo(m_Chunk->Get({ x, y, z - 1 }).GetID()).Transparent;
-
-                    bool renderRight = (x == chunk_size_XZ - 1) ?
-                        (hasRightChunk && ItemMenager::GetInfo(rightChunk->Get({ 0, y, z }).GetID()).Transparent)
-                        : ItemMenager::GetInfo(m_Chunk->Get({ x + 1, y, z }).GetID()).Transparent;
-
-                    bool renderLeft = (x == 0) ?
-                        (hasLeftChunk && ItemMenager::GetInfo(leftChunk->Get({ chunk_size_XZ - 1, y, z }).GetID()).Transparent)
-                        : ItemMenager::GetInfo(m_Chunk->Get({ x - 1, y, z }).GetID()).Transparent;
-
-                    if (renderFront)    
-                        AddFace({ x, y, z }, BlockFaces::Front);
-                    if (renderBehind)   
-                        AddFace({ x, y, z }, BlockFaces::Back);
-                    if (renderRight)    
-                        AddFace({ x, y, z }, BlockFaces::Right);
-                    if (renderLeft)     
-                        AddFace({ x, y, z }, BlockFaces::Left);
-                    if (y > 0 && renderBottom) 
-                        AddFace({ x, y, z }, BlockFaces::Bottom);
-                    if (renderTop)              
-                        AddFace({ x, y, z }, BlockFaces::Top);
+                    for (int word = 0; word < chunk_column_words; word++)
+                    {
+                        for (uint64_t bits = masks->Columns[face][x][z][word]; bits; bits &= bits - 1)
+                        {
+                            int y = word * 64 + std::countr_zero(bits);
+                            AddFace(output, snapshot.Get(x, y, z), { x, y, z }, (BlockFaces)face);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void ChunkRenderData::BuildGreedyMesh(const ChunkMeshSnapshot& snapshot, std::vector<uint32_t>& output)
+    {
+        auto masks = std::make_unique<ChunkFaceMasks>();
+        FindVisibleFaces(snapshot, *masks);
+
+        /// Axes of every face: the axis the face looks along and the axes of quad width and height
+        struct FaceAxes { int Depth, Width, Height; };
+        constexpr FaceAxes face_axes[block_face_count] = {
+            { 2, 0, 1 }, // Front
+            { 0, 2, 1 }, // Left
+            { 2, 0, 1 }, // Back
+            { 0, 2, 1 }, // Right
+            { 1, 0, 2 }, // Top
+            { 1, 0, 2 }, // Bottom
+        };
+        constexpr int chunk_size[3] = { chunk_size_XZ, chunk_size_Y, chunk_size_XZ };
+
+        /// Every cell holds texture layer and rotation of a visible face + 1, 0 means no face
+        std::vector<uint32_t> mask(chunk_size_XZ * chunk_size_Y);
+
+        for (uint8_t face = 0; face < block_face_count; face++)
+        {
+            const FaceAxes& axes = face_axes[face];
+            int width  = chunk_size[axes.Width];
+            int height = chunk_size[axes.Height];
+
+            for (int depth = 0; depth < chunk_size[axes.Depth]; depth++)
+            {
+                /// Horizontal slices of empty and enclosed sections have no faces
+                if (axes.Depth == 1 && snapshot.SkipSection[depth / chunk_section_size])
+                    continue;
+
+                bool anyFace = false;
+                glm::ivec3 position;
+                position[axes.Depth] = depth;
+                for (int v = 0; v < height; v++)
+                {
+                    position[axes.Height] = v;
+                    for (int u = 0; u < width; u++)
+                    {
+                        position[axes.Width] = u;
+
+                        uint32_t& cell = mask[v * width + u];
+                        cell = 0;
+
+                        if (masks->IsVisible((BlockFaces)face, position.x, position.y, position.z))
+                        {
+                            const Item& block = snapshot.Get(position.x, position.y, position.z);
+                            cell = ((ItemMenager::GetTextureLayer(block.GetID()) << 2) | (uint32_t)block.GetRotation()) + 1;
+                            anyFace = true;
+                        }
+                    }
+                }
+
+                if (!anyFace)
+                    continue;
+
+                for (int v = 0; v < height; v++)
+                {
+                    for (int u = 0; u < width; )
+                    {
+                        uint32_t key = mask[v * width + u];
+                        if (!key)
+                        {
+                            u++;
+                            continue;
+                        }
+
+                        /// Grow the quad along width, then along height while the whole row matches
+                        int quadWidth = 1;
+                        while (u + quadWidth < width && mask[v * width + u + quadWidth] == key)
+                            quadWidth++;
+
+                        int quadHeight = 1;
+                        for (; v + quadHeight < height; quadHeight++)
+                        {
+                            const uint32_t* row = &mask[(v + quadHeight) * width + u];
+                            if (!std::all_of(row, row + quadWidth, [key](uint32_t cell) { return cell == key; }))
+                                break;
+                        }
+
+                        for (int h = 0; h < quadHeight; h++)
+                            std::fill_n(&mask[(v + h) * width + u], quadWidth, 0u);
+
+                        position[axes.Width]  = u;
+                        position[axes.Height] = v;
+                        AddFace(output, snapshot.Get(position.x, position.y, position.z), position, (BlockFaces)face, quadWidth, quadHeight);
+
+                        u += quadWidth;
+                    }
+                }
+            }
+        }
+    }
+
+    void ChunkRenderData::FindVisibleFaces(const ChunkMeshSnapshot& snapshot, ChunkFaceMasks& masks)
+    {
+        using ColumnMask = std::array<uint64_t, chunk_column_words>;
+
+        auto isOpaque = [](const Item& item) {
+            return !ItemMenager::IsTransparent(item.GetID());
+        };
+
+        auto setBit = [](ColumnMask& column, int y) {
+            column[y >> 6] |= (uint64_t)1 << (y & 63);
+        };
+
+        /// Opaque blocks of the chunk padded with neighbors border slices, index 0 and chunk_size_XZ + 1 are the borders.
+        /// Missing neighbors are treated as opaque, so border faces stay hidden until they are built
+        ColumnMask opaque[chunk_size_XZ + 2][chunk_size_XZ + 2] = {};
+        ColumnMask solid[chunk_size_XZ][chunk_size_XZ] = {};
+
+        for (int i = 0; i < chunk_size_XZ; i++)
+        {
+            if (!snapshot.HasLeft)   opaque[0][i + 1]                 .fill(~0ull);
+            if (!snapshot.HasRight)  opaque[chunk_size_XZ + 1][i + 1] .fill(~0ull);
+            if (!snapshot.HasBehind) opaque[i + 1][0]                 .fill(~0ull);
+            if (!snapshot.HasFront)  opaque[i + 1][chunk_size_XZ + 1] .fill(~0ull);
+        }
+
+        for (int y = 0; y < chunk_size_Y; y++)
+        {
+            for (int i = 0; i < chunk_size_XZ; i++)
+            {
+                if (snapshot.HasLeft   && isOpaque(snapshot.Left[y][i]))   setBit(opaque[0][i + 1],                 y);
+                if (snapshot.HasRight  && isOpaque(snapshot.Right[y][i]))  setBit(opaque[chunk_size_XZ + 1][i + 1], y);
+                if (snapshot.HasBehind && isOpaque(snapshot.Behind[y][i])) setBit(opaque[i + 1][0],                 y);
+                if (snapshot.HasFront  && isOpaque(snapshot.Front[y][i]))  setBit(opaque[i + 1][chunk_size_XZ + 1], y);
+            }
+        }
+
+        /// Skipped sections only hide solid bits, their opacity still culls faces of the sections around them
+        ColumnMask sectionMask = {};
+        for (int section = 0; section < chunk_section_count; section++)
+        {
+            if (!snapshot.SkipSection[section])
+                sectionMask[(section * chunk_section_size) >> 6] |= (uint64_t)0xFFFF << ((section * chunk_section_size) & 63);
+        }
+
+        for (int section = 0; section < chunk_section_count; section++)
+        {
+            int minY = section * chunk_section_size;
+            int maxY = minY + chunk_section_size;
+
+            for (int x = 0; x < chunk_size_XZ; x++)
+            {
+                for (int y = minY; y < maxY; y++)
+                {
+                    for (int z = 0; z < chunk_size_XZ; z++)
+                    {
+                        const Item& block = snapshot.Get(x, y, z);
+                        if (block.GetID() == (ItemID)ItemData::Air)
+                            continue;
+
+                        setBit(solid[x][z], y);
+                        if (isOpaque(block))
+                            setBit(opaque[x + 1][z + 1], y);
+                    }
+                }
+            }
+        }
+
+        for (int x = 0; x < chunk_size_XZ; x++)
+        {
+            for (int z = 0; z < chunk_size_XZ; z++)
+            {
+                const ColumnMask& column = opaque[x + 1][z + 1];
+                const ColumnMask& left   = opaque[x    ][z + 1];
+                const ColumnMask& right  = opaque[x + 2][z + 1];
+                const ColumnMask& behind = opaque[x + 1][z    ];
+                const ColumnMask& front  = opaque[x + 1][z + 2];
+
+                for (int word = 0; word < chunk_column_words; word++)
+                {
+                    uint64_t blocks = solid[x][z][word] & sectionMask[word];
+
+                    /// Bit y of above/below tells whether block y + 1/y - 1 is opaque, the bottom of the world counts as opaque
+                    uint64_t above = (column[word] >> 1) | (word + 1 < chunk_column_words ? column[word + 1] << 63 : 0);
+                    uint64_t below = (column[word] << 1) | (word > 0 ? column[word - 1] >> 63 : 1);
+
+                    masks.Columns[(uint8_t)BlockFaces::Top]   [x][z][word] = blocks & ~above;
+                    masks.Columns[(uint8_t)BlockFaces::Bottom][x][z][word] = blocks & ~below;
+                    masks.Columns[(uint8_t)BlockFaces::Left]  [x][z][word] = blocks & ~left[word];
+                    masks.Columns[(uint8_t)BlockFaces::Right] [x][z][word] = blocks & ~right[word];
+                    masks.Columns[(uint8_t)BlockFaces::Back]  [x][z][word] = blocks & ~behind[word];
+                    masks.Columns[(uint8_t)BlockFaces::Front] [x][z][word] = blocks & ~front[word];
+                }
+            }
+        }
+    }
+
+    void ChunkRenderData::FindVisibleFacesReference(const ChunkMeshSnapshot& snapshot, ChunkFaceMasks& masks)
+    {
+        auto isTransparent = [](const Item& item) {
+            return ItemMenager::IsTransparent(item.GetID());
+        };
+
+        uint64_t* words = &masks.Columns[0][0][0][0];
+        std::fill(words, words + sizeof(masks.Columns) / sizeof(uint64_t), 0ull);
+
+        for (int section = 0; section < chunk_section_count; section++)
+        {
+            /// Empty and enclosed sections can not produce any face
+            if (snapshot.SkipSection[section])
+                continue;
+
+            int minY = section * chunk_section_size;
+            int maxY = minY + chunk_section_size;
+
+            for (int x = 0; x < chunk_size_XZ; x++)
+            {
+                for (int y = minY; y < maxY; y++)
+                {
+                    for (int z = 0; z < chunk_size_XZ; z++)
+                    {
+                        const Item& block = snapshot.Get(x, y, z);
+                        if (block.GetID() == (ItemID)ItemData::Air)
+                            continue;
+
+                        bool renderBottom = (y > 0) && isTransparent(snapshot.Get(x, y - 1, z));
+
+                        bool renderTop = (y == chunk_size_Y - 1) || isTransparent(snapshot.Get(x, y + 1, z));
+
+                        bool renderFront = (z == chunk_size_XZ - 1) ?
+                            (snapshot.HasFront && isTransparent(snapshot.Front[y][x]))
+                            : isTransparent(snapshot.Get(x, y, z + 1));
+
+                        bool renderBehind = (z == 0) ?
+                            (snapshot.HasBehind && isTransparent(snapshot.Behind[y][x]))
+                            : isTransparent(snapshot.Get(x, y, z - 1));
+
+                        bool renderRight = (x == chunk_size_XZ - 1) ?
+                            (snapshot.HasRight && isTransparent(snapshot.Right[y][z]))
+                            : isTransparent(snapshot.Get(x + 1, y, z));
+
+                        bool renderLeft = (x == 0) ?
+                            (snapshot.HasLeft && isTransparent(snapshot.Left[y][z]))
+                            : isTransparent(snapshot.Get(x - 1, y, z));
+
+                        uint64_t bit = (uint64_t)1 << (y & 63);
+                        masks.Columns[(uint8_t)BlockFaces::Front] [x][z][y >> 6] |= renderFront  ? bit : 0;
+                        masks.Columns[(uint8_t)BlockFaces::Back]  [x][z][y >> 6] |= renderBehind ? bit : 0;
+                        masks.Columns[(uint8_t)BlockFaces::Right] [x][z][y >> 6] |= renderRight  ? bit : 0;
+                        masks.Columns[(uint8_t)BlockFaces::Left]  [x][z][y >> 6] |= renderLeft   ? bit : 0;
+                        masks.Columns[(uint8_t)BlockFaces::Bottom][x][z][y >> 6] |= renderBottom ? bit : 0;
+                        masks.Columns[(uint8_t)BlockFaces::Top]   [x][z][y >> 6] |= renderTop    ? bit : 0;
+                    }
                 }
             }
         }
     }
 
-    void ChunkRenderData::AddFace(const glm::ivec3& position, BlockFaces face)
+    void ChunkRenderData::SwapBuffers()
+    {
+        std::swap(m_Data, m_BackData);
+        m_NeedsUpload = true;
+
+        /// Old mesh is either already on the GPU or was never uploaded
+        m_BackData.clear();
+        m_BackData.shrink_to_fit();
+    }
+
+    void ChunkRenderData::OnUploaded(const BufferAllocation& allocation)
     {
-        const Item& block = m_Chunk->m_Data[position.x][position.y][position.z];
+        m_Allocation  = allocation;
+        m_NeedsUpload = false;
+
+        /// The mesh lives on the GPU from now on
+        m_Data.clear();
+        m_Data.shrink_to_fit();
+    }
 
+    void ChunkRenderData::AddFace(std::vector<uint32_t>& output, const Item& block, const glm::ivec3& position, BlockFaces face, uint32_t width, uint32_t height)
+    {
         uint32_t basePackedData1 =
             ((position.x & 0xF)) | 
             ((position.y & 0xFF) << 4) |
@@ -95,13 +338,15 @@ namespace KuchCraft
             ((ItemMenager::GetTextureLayer(block.GetID()) & 0x1FF) << 19) |
             (((uint8_t)block.GetRotation() & 0x03) << 30);
 
-        uint32_t basePackedData2 = 0;
+        uint32_t basePackedData2 =
+            (((width  - 1) & 0xFF)) |
+            (((height - 1) & 0xFF) << 8);
 
         for (uint32_t i = 0; i < quad_vertex_count; i++)
         {
-            m_Data.push_back(basePackedData1 | ((i & 0x03) << 28) );
-            m_Data.push_back(basePackedData2);
+            output.push_back(basePackedData1 | ((i & 0x03) << 28) );
+            output.push_back(basePackedData2);
         }
     }
 
-}
\ No newline at end of file
+}
@@ -2,9 +2,13 @@
 
 #include "World/Item/ItemData.h"
 
+#include "Graphics/Data/BufferAllocator.h"
+
 namespace KuchCraft {
 
 	class Chunk;
+	struct ChunkMeshSnapshot;
+	struct ChunkFaceMasks;
 
 	class ChunkRenderData
 	{
@@ -15,14 +19,59 @@ namespace KuchCraft {
 
 		~ChunkRenderData();
 
-		/// Recreates the chunk rendering data.
-		/// Clears and rebuilds the vertex data for the chunk.
-		void Recreate();
+		/// Rebuilds the vertex data for the chunk into the back buffer.
+		/// Only reads the snapshot, so it can run on a worker thread while the front buffer is used for rendering.
+		/// @param snapshot Snapshot of the chunk and its neighbors border slices.
+		void Recreate(const ChunkMeshSnapshot& snapshot);
+
+		/// Publishes the mesh built by Recreate() by swapping the back and front buffers.
+		/// Must be called on the main thread once Recreate() has finished.
+		void SwapBuffers();
 
 		/// Retrieves the packed vertex data.
+		/// The data is released once it has been uploaded to the GPU.
 		/// @return Reference to the vector containing packed vertex data.
 		const auto& GetData() const { return m_Data; }
 
+		/// Checks if the mesh was rebuilt and is not yet resident on the GPU.
+		/// @return True if the mesh has to be uploaded before drawing.
+		bool NeedsUpload() const { return m_NeedsUpload; }
+
+		/// Marks the rebuilt mesh as resident on the GPU and releases the CPU copy.
+		/// @param allocation The range of the shared chunk vertex buffer holding the mesh.
+		void OnUploaded(const BufferAllocation& allocation);
+
+		/// Retrieves the range of the shared chunk vertex buffer holding the mesh.
+		/// @return The allocation, invalid if the mesh is not resident.
+		const BufferAllocation& GetAllocation() const { return m_Allocation; }
+
+		/// Retrieves the number of quads resident on the GPU.
+		/// @return Number of quads stored in the chunk's vertex buffer range.
+		uint32_t GetQuadCount() const { return m_Allocation.Size / quad_vertex_count; }
+
+		/// Builds a mesh with one quad per visible block face.
+		/// @param snapshot Snapshot of the chunk and its neighbors border slices.
+		/// @param output Vector the packed vertex data is appended to.
+		static void BuildMesh(const ChunkMeshSnapshot& snapshot, std::vector<uint32_t>& output);
+
+		/// Builds a mesh merging coplanar neighboring faces with the same texture layer and rotation into larger quads.
+		/// @param snapshot Snapshot of the chunk and its neighbors border slices.
+		/// @param output Vector the packed vertex data is appended to.
+		static void BuildGreedyMesh(const ChunkMeshSnapshot& snapshot, std::vector<uint32_t>& output);
+
+		/// Calculates which faces of every block are visible.
+		/// Builds per column opacity bit masks of the chunk and its neighbors border slices once,
+		/// then culls all faces of a column with a few shifts and ANDs.
+		/// @param snapshot Snapshot of the chunk and its neighbors border slices.
+		/// @param masks Output visible faces.
+		static void FindVisibleFaces(const ChunkMeshSnapshot& snapshot, ChunkFaceMasks& masks);
+
+		/// Calculates which faces of every block are visible by checking the neighbors of every block one by one.
+		/// Much slower than FindVisibleFaces(), kept as a reference for benchmarks and validation.
+		/// @param snapshot Snapshot of the chunk and its neighbors border slices.
+		/// @param masks Output visible faces.
+		static void FindVisibleFacesReference(const ChunkMeshSnapshot& snapshot, ChunkFaceMasks& masks);
+
 	private:
 		/// Packs vertex data for a block face into a compact format.
 		///
@@ -37,21 +86,39 @@ namespace KuchCraft {
 		///   - [30-31] (2 bits)   - Block rotation (0-3)
 		///
 		/// - **packedData2 (32 bits)**:
-		///   - Reserved for future use.
+		///   - [0-7]   (8 bits)   - Quad width - 1 (0-255)
+		///   - [8-15]  (8 bits)   - Quad height - 1 (0-255)
+		///   - [16-31] (16 bits)  - Reserved for future use.
+		///
+		/// Quad width runs along X for front, back, top and bottom faces and along Z for left and right faces,
+		/// height runs along Y for side faces and along Z for top and bottom faces.
 		///
 		/// This structure ensures efficient memory usage while enabling fast GPU vertex processing.
 		///
-		/// @param position The block's position within the chunk.
+		/// @param output Vector the packed vertex data is appended to.
+		/// @param block The block being rendered.
+		/// @param position The position of the quad's minimum corner block within the chunk.
 		/// @param face The face of the block being rendered.
-		void AddFace(const glm::ivec3& position, BlockFaces face);
+		/// @param width Quad width in blocks.
+		/// @param height Quad height in blocks.
+		static void AddFace(std::vector<uint32_t>& output, const Item& block, const glm::ivec3& position, BlockFaces face, uint32_t width = 1, uint32_t height = 1);
 
 	private:
 		/// Pointer to the associated chunk.
 		Chunk* m_Chunk = nullptr;
 
-		/// Stores packed vertex data for rendering.
+		/// Stores packed vertex data for rendering (front buffer).
 		std::vector<uint32_t> m_Data;
 
+		/// Packed vertex data being built by a worker thread (back buffer).
+		std::vector<uint32_t> m_BackData;
+
+		/// Whether m_Data holds a mesh that has not been uploaded yet.
+		bool m_NeedsUpload = false;
+
+		/// Range of the shared chunk vertex buffer (in vertices) holding the GPU resident mesh.
+		BufferAllocation m_Allocation;
+
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+///
+/// @file ChunkSerializer.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/ChunkSerializer.h"
+
+#include "World/Chunk/Chunk.h"
+
+namespace KuchCraft {
+
+	static_assert(chunk_section_count <= 16, "Section mask is stored in 16 bits");
+	static_assert(chunk_section_block_count <= UINT16_MAX, "Run length is stored in 16 bits");
+
+	/// Appends a value to the payload.
+	template<typename T>
+	static void WriteValue(std::vector<uint8_t>& payload, const T& value)
+	{
+		size_t offset = payload.size();
+		payload.resize(offset + sizeof(T));
+		std::memcpy(payload.data() + offset, &value, sizeof(T));
+	}
+
+	/// Reads values from a payload, every read after running out of data fails.
+	struct ChunkSerializer::PayloadReader
+	{
+		const uint8_t* Payload = nullptr;
+		size_t         Size    = 0;
+		size_t         Offset  = 0;
+
+		template<typename T>
+		bool Read(T& value)
+		{
+			if (Offset + sizeof(T) > Size)
+				return false;
+
+			std::memcpy(&value, Payload + Offset, sizeof(T));
+			Offset += sizeof(T);
+			return true;
+		}
+	};
+
+	void ChunkSerializer::Encode(const ChunkSaveSnapshot& snapshot, std::vector<uint8_t>& payload)
+	{
+		/// Decoded blocks of a single section, reused by every chunk encoded on the thread
+		thread_local std::array<Item, chunk_section_block_count> blocks;
+
+		payload.clear();
+		WriteValue(payload, format_version);
+		WriteValue(payload, snapshot.ClimateMap);
+
+		uint16_t sectionMask = 0;
+		for (int i = 0; i < chunk_section_count; i++)
+		{
+			if (snapshot.Sections[i])
+				sectionMask |= (uint16_t)(1u << i);
+		}
+
+		WriteValue(payload, sectionMask);
+
+		for (const auto& section : snapshot.Sections)
+		{
+			if (!section)
+				continue;
+
+			if (section->IsUniform())
+			{
+				const Item& item = section->Get(0);
+				WriteValue(payload, (uint16_t)1);
+				WriteValue(payload, (uint16_t)chunk_section_block_count);
+				WriteValue(payload, item.GetID());
+				WriteValue(payload, (uint8_t)item.GetRotation());
+				continue;
+			}
+
+			section->Unpack(blocks.data());
+
+			/// Run count is patched once the section is done
+			size_t   runCountOffset = payload.size();
+			uint16_t runCount       = 0;
+			WriteValue(payload, runCount);
+
+			for (uint32_t start = 0; start < chunk_section_block_count; runCount++)
+			{
+				uint32_t end = start + 1;
+				while (end < chunk_section_block_count && blocks[end] == blocks[start])
+					end++;
+
+				WriteValue(payload, (uint16_t)(end - start));
+				WriteValue(payload, blocks[start].GetID());
+				WriteValue(payload, (uint8_t)blocks[start].GetRotation());
+				start = end;
+			}
+
+			std::memcpy(payload.data() + runCountOffset, &runCount, sizeof(runCount));
+		}
+	}
+
+	void ChunkSerializer::EncodeEdits(const ChunkSaveSnapshot& snapshot, std::vector<uint8_t>& payload)
+	{
+		payload.clear();
+		WriteValue(payload, format_version);
+
+		/// Run count is patched once all edits are written
+		uint32_t runCount = 0;
+		WriteValue(payload, runCount);
+
+		const auto& edits = snapshot.Edits;
+		for (auto it = edits.begin(); it != edits.end(); runCount++)
+		{
+			uint16_t    first = it->first;
+			const Item& item  = it->second.Current;
+
+			uint32_t length = 1;
+			for (++it; it != edits.end() && it->first == first + length && it->second.Current == item && length < UINT16_MAX; ++it)
+				length++;
+
+			WriteValue(payload, first);
+			WriteValue(payload, (uint16_t)length);
+			WriteValue(payload, item.GetID());
+			WriteValue(payload, (uint8_t)item.GetRotation());
+		}
+
+		std::memcpy(payload.data() + sizeof(format_version), &runCount, sizeof(runCount));
+	}
+
+	void ChunkSerializer::Restore(Chunk* chunk, const ChunkSaveSnapshot& snapshot)
+	{
+		if (snapshot.SaveEdits)
+		{
+			chunk->m_Edits = snapshot.Edits;
+			return;
+		}
+
+		/// Sections stay shared, whoever writes to a shared section copies it first
+		chunk->m_ClimateMap = snapshot.ClimateMap;
+		for (int i = 0; i < chunk_section_count; i++)
+			chunk->m_Sections[i] = std::const_pointer_cast<PalettedContainer>(snapshot.Sections[i]);
+	}
+
+	bool ChunkSerializer::Decode(Chunk* chunk, RegionCompression compression, const uint8_t* payload, size_t size)
+	{
+		PayloadReader reader{ payload, size };
+
+		uint8_t version = 0;
+		if (!reader.Read(version) || version != format_version)
+		{
+			Log::Error("[Chunk Serializer] : Unsupported format version : {}", version);
+			return false;
+		}
+
+		switch (compression)
+		{
+			case RegionCompression::BlockRuns:  return DecodeBlockRuns(chunk, reader);
+			case RegionCompression::BlockEdits: return DecodeBlockEdits(chunk, reader);
+			default:
+				Log::Error("[Chunk Serializer] : Unsupported compression : {}", (uint32_t)compression);
+				return false;
+		}
+	}
+
+	bool ChunkSerializer::DecodeBlockEdits(Chunk* chunk, PayloadReader& reader)
+	{
+		uint32_t runCount = 0;
+		if (!reader.Read(runCount))
+		{
+			Log::Error("[Chunk Serializer] : Truncated edits header");
+			return false;
+		}
+
+		std::map<uint16_t, ChunkEdit> edits;
+		for (uint32_t run = 0; run < runCount; run++)
+		{
+			uint16_t first    = 0;
+			uint16_t length   = 0;
+			ItemID   id       = 0;
+			uint8_t  rotation = 0;
+			if (!reader.Read(first) || !reader.Read(length) || !reader.Read(id) || !reader.Read(rotation) || first + length > chunk_block_count)
+			{
+				Log::Error("[Chunk Serializer] : Invalid edit run {}", run);
+				return false;
+			}
+
+			/// Originals are known once the terrain is generated again
+			Item item(id, (ItemRotation)rotation);
+			for (uint32_t i = 0; i < length; i++)
+				edits.emplace_hint(edits.end(), (uint16_t)(first + i), ChunkEdit{ item, item });
+		}
+
+		chunk->m_Edits = std::move(edits);
+		return true;
+	}
+
+	bool ChunkSerializer::DecodeBlockRuns(Chunk* chunk, PayloadReader& reader)
+	{
+		thread_local std::array<Item, chunk_section_block_count> blocks;
+
+		ChunkClimateMap climateMap;
+		uint16_t        sectionMask = 0;
+		if (!reader.Read(climateMap) || !reader.Read(sectionMask))
+		{
+			Log::Error("[Chunk Serializer] : Truncated chunk header");
+			return false;
+		}
+
+		/// Sections are decoded aside, so an invalid payload does not leave a half filled chunk
+		std::array<std::shared_ptr<PalettedContainer>, chunk_section_count> sections;
+
+		const Item air(ItemData::Air);
+		for (int i = 0; i < chunk_section_count; i++)
+		{
+			if (!(sectionMask & (1u << i)))
+				continue;
+
+			uint16_t runCount = 0;
+			if (!reader.Read(runCount) || runCount == 0)
+			{
+				Log::Error("[Chunk Serializer] : Invalid section {}", i);
+				return false;
+			}
+
+			uint32_t filled = 0;
+			for (uint16_t run = 0; run < runCount; run++)
+			{
+				uint16_t length   = 0;
+				ItemID   id       = 0;
+				uint8_t  rotation = 0;
+				if (!reader.Read(length) || !reader.Read(id) || !reader.Read(rotation) || filled + length > chunk_section_block_count)
+				{
+					Log::Error("[Chunk Serializer] : Invalid run in section {}", i);
+					return false;
+				}
+
+				std::fill_n(blocks.begin() + filled, length, Item(id, (ItemRotation)rotation));
+				filled += length;
+			}
+
+			if (filled != chunk_section_block_count)
+			{
+				Log::Error("[Chunk Serializer] : Section {} holds {} blocks", i, filled);
+				return false;
+			}
+
+			if (runCount == 1)
+			{
+				if (!(blocks[0] == air))
+					sections[i] = std::make_shared<PalettedContainer>(chunk_section_block_count, blocks[0]);
+			}
+			else
+			{
+				sections[i] = std::make_shared<PalettedContainer>(chunk_section_block_count, air);
+				sections[i]->Pack(blocks.data());
+			}
+		}
+
+		chunk->m_ClimateMap = climateMap;
+		chunk->m_Sections   = std::move(sections);
+
+		return true;
+	}
+
+}
@@ -0,0 +1,76 @@
+///
+/// @file ChunkSerializer.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkSerializer class, which converts
+///        the blocks and climate of a chunk to the payload of a region file record and back.
+///
+/// @details Snapshot payload layout (RegionCompression::BlockRuns), little-endian:
+///          uint8 format version, the four ChunkClimateMap arrays, uint16 mask of stored sections,
+///          then for every stored section a uint16 run count followed by runs of
+///          uint16 length, uint16 item id and uint8 rotation in section index order.
+///          Sections holding only air are not stored. Terrain sections are mostly made of long runs,
+///          so a typical chunk takes a few kilobytes instead of the 128 KB of its dense blocks.
+///
+///          Edits payload layout (RegionCompression::BlockEdits), little-endian:
+///          uint8 format version, uint32 run count, then runs of uint16 first chunk block index,
+///          uint16 length, uint16 item id and uint8 rotation. A run covers edits of consecutive blocks
+///          placing the same item. The terrain is generated again from the seed when the chunk is loaded,
+///          so a chunk with a few edits takes tens of bytes.
+///
+/// @thread_safety Thread-safe, as long as the chunk is not modified while it is decoded.
+///                 Snapshots are immutable and can be encoded on any thread.
+///
+
+#pragma once
+
+#include "World/Chunk/RegionFile.h"
+
+namespace KuchCraft {
+
+	class Chunk;
+	struct ChunkSaveSnapshot;
+
+	class ChunkSerializer
+	{
+	public:
+		/// Current version of the payload layout.
+		static constexpr uint8_t format_version = 1;
+
+		/// Encodes the blocks and climate of a chunk snapshot as a RegionCompression::BlockRuns snapshot.
+		/// @param snapshot - the snapshot of the whole chunk.
+		/// @param payload - receives the encoded data, previous content is replaced.
+		static void Encode(const ChunkSaveSnapshot& snapshot, std::vector<uint8_t>& payload);
+
+		/// Encodes the edits of a chunk snapshot as RegionCompression::BlockEdits.
+		/// @param snapshot - the snapshot of the chunk edits.
+		/// @param payload - receives the encoded data, previous content is replaced.
+		static void EncodeEdits(const ChunkSaveSnapshot& snapshot, std::vector<uint8_t>& payload);
+
+		/// Fills a chunk that was not built yet from a snapshot that was not written yet, like Decode() does.
+		/// @param chunk - the chunk to fill.
+		/// @param snapshot - the snapshot.
+		static void Restore(Chunk* chunk, const ChunkSaveSnapshot& snapshot);
+
+		/// Decodes a payload into a chunk that was not built yet, the chunk is left untouched on failure.
+		/// Snapshots fill the blocks and climate, edits only fill the edit list and have to be applied
+		/// with Chunk::ApplyEdits() once the chunk is generated.
+		/// @param chunk - the chunk to fill.
+		/// @param compression - the compression type stored with the payload.
+		/// @param payload - the encoded data, read in place.
+		/// @param size - the size of the encoded data in bytes.
+		/// @return True if the payload was valid.
+		static bool Decode(Chunk* chunk, RegionCompression compression, const uint8_t* payload, size_t size);
+
+	private:
+		struct PayloadReader;
+
+		/// Decodes the rest of a snapshot payload.
+		static bool DecodeBlockRuns(Chunk* chunk, PayloadReader& reader);
+
+		/// Decodes the rest of an edits payload.
+		static bool DecodeBlockEdits(Chunk* chunk, PayloadReader& reader);
+	};
+
+}
@@ -0,0 +1,329 @@
+///
+/// @file ChunkStorage.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/ChunkStorage.h"
+
+#include "World/Chunk/Chunk.h"
+#include "World/Chunk/ChunkGrid.h"
+#include "World/Chunk/ChunkSerializer.h"
+
+#ifdef  INCLUDE_IMGUI
+	#include <imgui.h>
+#endif
+
+namespace KuchCraft {
+
+	/// Number of cached regions above which regions not used by any thread are closed
+	constexpr size_t max_open_regions = 64;
+
+	/// How many chunks ahead of the player saved chunks are prefetched
+	constexpr float chunk_prefetch_distance = 4.0f;
+
+	void ChunkStorage::SetDirectory(const std::filesystem::path& directory)
+	{
+		/// Closing a region syncs it, which must not happen while the cache is locked
+		std::unordered_map<uint64_t, std::shared_ptr<RegionFile>> closedRegions;
+
+		std::lock_guard lock(m_RegionsMutex);
+
+		m_Directory = directory;
+		std::swap(closedRegions, m_Regions);
+		m_HasDirectory = !directory.empty();
+	}
+
+	ChunkLoadResult ChunkStorage::Load(Chunk* chunk)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		glm::ivec2 coord = chunk->GetCoord();
+
+		/// Snapshots waiting for the save thread are newer than anything in the region
+		{
+			std::lock_guard lock(m_PendingMutex);
+			if (auto it = m_Pending.find(GetCoordKey(coord)); it != m_Pending.end())
+			{
+				const ChunkSaveSnapshot& snapshot = *it->second;
+				ChunkSerializer::Restore(chunk, snapshot);
+				m_RestoredChunks++;
+				return snapshot.SaveEdits ? ChunkLoadResult::Edits : ChunkLoadResult::Snapshot;
+			}
+		}
+
+		glm::ivec2 local  = RegionFile::GetLocalCoord(coord);
+		auto       region = GetRegion(RegionFile::GetRegionCoord(coord), false);
+		if (!region || !region->Contains(local))
+			return ChunkLoadResult::NotSaved;
+
+		size_t            bytes = 0;
+		RegionCompression type  = RegionCompression::None;
+		bool valid = region->Read(local, [&](RegionCompression compression, const uint8_t* payload, size_t size) {
+			bytes = size;
+			type  = compression;
+			return ChunkSerializer::Decode(chunk, compression, payload, size);
+		});
+
+		if (!valid)
+		{
+			Log::Warn("[Chunk Storage] : Chunk ({}, {}) is damaged and will be generated again", coord.x, coord.y);
+			m_LoadFailures++;
+			return ChunkLoadResult::NotSaved;
+		}
+
+		m_LoadedChunks++;
+		m_BytesRead  += bytes;
+		m_LoadTimeNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+		return type == RegionCompression::BlockEdits ? ChunkLoadResult::Edits : ChunkLoadResult::Snapshot;
+	}
+
+	void ChunkStorage::QueueSave(std::shared_ptr<const ChunkSaveSnapshot> snapshot)
+	{
+		/// Without a directory nothing could ever be written
+		if (!m_HasDirectory)
+			return;
+
+		std::lock_guard lock(m_PendingMutex);
+
+		/// A newer snapshot of the same chunk replaces the one not written yet
+		m_Pending[GetCoordKey(snapshot->Coord)] = std::move(snapshot);
+	}
+
+	bool ChunkStorage::WritePending()
+	{
+		std::vector<std::shared_ptr<const ChunkSaveSnapshot>> snapshots;
+		{
+			std::lock_guard lock(m_PendingMutex);
+
+			snapshots.reserve(m_Pending.size());
+			for (const auto& [key, snapshot] : m_Pending)
+				snapshots.push_back(snapshot);
+		}
+
+		bool written = true;
+		for (const auto& snapshot : snapshots)
+		{
+			std::shared_ptr<RegionFile> region;
+			if (!Write(*snapshot, region))
+			{
+				/// Stays queued, so it is still loaded from memory and written by the next save
+				written = false;
+				continue;
+			}
+
+			if (region && std::find(m_UnsyncedRegions.begin(), m_UnsyncedRegions.end(), region) == m_UnsyncedRegions.end())
+				m_UnsyncedRegions.push_back(region);
+
+			/// The chunk could have been queued again while it was written
+			std::lock_guard lock(m_PendingMutex);
+			if (auto it = m_Pending.find(GetCoordKey(snapshot->Coord)); it != m_Pending.end() && it->second == snapshot)
+				m_Pending.erase(it);
+		}
+
+		/// Written records survive a crash only once their region is synced,
+		/// regions failing to sync are kept and tried again by the next call
+		std::erase_if(m_UnsyncedRegions, [&](const std::shared_ptr<RegionFile>& region) {
+			if (region->Sync())
+				return true;
+
+			written = false;
+			return false;
+		});
+
+		return written;
+	}
+
+	bool ChunkStorage::Write(const ChunkSaveSnapshot& snapshot, std::shared_ptr<RegionFile>& region)
+	{
+		glm::ivec2 local = RegionFile::GetLocalCoord(snapshot.Coord);
+
+		/// Unedited terrain is only written to replace an older record of the chunk
+		bool unedited = snapshot.SaveEdits && snapshot.Edits.empty();
+		region = GetRegion(RegionFile::GetRegionCoord(snapshot.Coord), !unedited);
+		if (unedited && (!region || !region->Contains(local)))
+		{
+			region = nullptr;
+			m_SkippedChunks++;
+			return true;
+		}
+
+		if (!region)
+			return false;
+
+		thread_local std::vector<uint8_t> payload;
+		if (snapshot.SaveEdits)
+			ChunkSerializer::EncodeEdits(snapshot, payload);
+		else
+			ChunkSerializer::Encode(snapshot, payload);
+
+		RegionCompression compression = snapshot.SaveEdits ? RegionCompression::BlockEdits : RegionCompression::BlockRuns;
+		if (!region->Write(local, compression, payload.data(), payload.size()))
+			return false;
+
+		if (snapshot.SaveEdits)
+		{
+			m_SavedEdits++;
+			m_EditBytes += payload.size();
+		}
+		else
+		{
+			m_SavedSnapshots++;
+			m_SnapshotBytes += payload.size();
+		}
+
+		return true;
+	}
+
+	size_t ChunkStorage::GetPendingCount() const
+	{
+		std::lock_guard lock(m_PendingMutex);
+		return m_Pending.size();
+	}
+
+	void ChunkStorage::PrefetchAhead(const glm::ivec2& center, const glm::vec2& direction, int radius)
+	{
+		if (direction == glm::vec2(0.0f))
+			return;
+
+		/// Crescent of the disc moved ahead of the player that is not loaded yet
+		glm::ivec2 ahead = center + glm::ivec2(glm::round(glm::normalize(direction) * chunk_prefetch_distance));
+
+		glm::ivec2                  regionCoord = { 0, 0 };
+		std::shared_ptr<RegionFile> region;
+		bool                        hasRegion = false;
+
+		ChunkGrid::ForEachInDiscDifference(ahead, radius, center, radius, [&](const glm::ivec2& coord) {
+			/// Neighboring chunks usually share a region
+			if (!hasRegion || RegionFile::GetRegionCoord(coord) != regionCoord)
+			{
+				regionCoord = RegionFile::GetRegionCoord(coord);
+				region      = GetRegion(regionCoord, false);
+				hasRegion   = true;
+			}
+
+			if (region && region->Prefetch(RegionFile::GetLocalCoord(coord)))
+				m_PrefetchedChunks++;
+		});
+	}
+
+	ChunkStorageReadBenchmark ChunkStorage::RunReadBenchmark(const glm::ivec2& start, const glm::vec2& direction, int radius, int distance)
+	{
+		/// Chunks in the order the flight loads them, the starting disc first and then every crescent entering it
+		std::vector<glm::ivec2> coords;
+		glm::vec2  step     = direction == glm::vec2(0.0f) ? glm::vec2(1.0f, 0.0f) : glm::normalize(direction);
+		glm::ivec2 previous = start;
+		for (int i = 0; i <= distance; i++)
+		{
+			glm::ivec2 center = start + glm::ivec2(glm::round(step * (float)i));
+			ChunkGrid::ForEachInDiscDifference(center, radius, previous, i == 0 ? -1 : radius, [&](const glm::ivec2& coord) {
+				coords.push_back(coord);
+			});
+			previous = center;
+		}
+
+		auto chunk = std::make_unique<Chunk>(nullptr, glm::vec3(0.0f));
+
+		ChunkStorageReadBenchmark result;
+		auto measure = [&](auto&& load) {
+			result.Chunks = 0;
+			result.Bytes  = 0;
+
+			auto begin = std::chrono::steady_clock::now();
+			for (const glm::ivec2& coord : coords)
+			{
+				auto region = GetRegion(RegionFile::GetRegionCoord(coord), false);
+				if (region && load(*region, RegionFile::GetLocalCoord(coord)))
+					result.Chunks++;
+			}
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		};
+
+		auto loadMapped = [&](RegionFile& region, const glm::ivec2& local) {
+			return region.Read(local, [&](RegionCompression compression, const uint8_t* payload, size_t size) {
+				result.Bytes += size;
+				return ChunkSerializer::Decode(chunk.get(), compression, payload, size);
+			});
+		};
+
+		std::vector<uint8_t> payload;
+		auto loadBuffered = [&](RegionFile& region, const glm::ivec2& local) {
+			RegionCompression compression = RegionCompression::None;
+			if (!region.ReadBuffered(local, compression, payload))
+				return false;
+
+			result.Bytes += payload.size();
+			return ChunkSerializer::Decode(chunk.get(), compression, payload.data(), payload.size());
+		};
+
+		measure(loadMapped);
+		result.MappedMs   = measure(loadMapped);
+		result.BufferedMs = measure(loadBuffered);
+		result.Done       = true;
+
+		return result;
+	}
+
+	std::shared_ptr<RegionFile> ChunkStorage::GetRegion(const glm::ivec2& regionCoord, bool create)
+	{
+		/// Closing a region syncs it, evicted regions are destroyed once the cache is unlocked
+		std::vector<std::shared_ptr<RegionFile>> evictedRegions;
+
+		std::lock_guard lock(m_RegionsMutex);
+
+		if (m_Directory.empty())
+			return nullptr;
+
+		uint64_t key = GetCoordKey(regionCoord);
+		if (auto it = m_Regions.find(key); it != m_Regions.end() && (it->second || !create))
+			return it->second;
+
+		if (m_Regions.size() >= max_open_regions)
+		{
+			std::erase_if(m_Regions, [&](auto& entry) {
+				if (entry.second && entry.second.use_count() > 1)
+					return false;
+
+				evictedRegions.push_back(std::move(entry.second));
+				return true;
+			});
+		}
+
+		std::string fileName = "r." + std::to_string(regionCoord.x) + "." + std::to_string(regionCoord.y) + ".kcr";
+		auto region = std::make_shared<RegionFile>(m_Directory / fileName, create);
+		if (!region->IsOpen())
+			region = nullptr;
+
+		m_Regions[key] = region;
+		return region;
+	}
+
+	void ChunkStorage::RenderImGui() const
+	{
+#ifdef  INCLUDE_IMGUI
+		constexpr float kilo_byte = 1024.0f;
+
+		size_t openRegions = 0;
+		{
+			std::lock_guard lock(m_RegionsMutex);
+			for (const auto& [key, region] : m_Regions)
+				openRegions += region ? 1 : 0;
+		}
+
+		uint64_t loaded    = m_LoadedChunks;
+		uint64_t snapshots = m_SavedSnapshots;
+		uint64_t edits     = m_SavedEdits;
+
+		ImGui::Text("Open region files: %zu", openRegions);
+		ImGui::Text("Loaded chunks: %llu (%.1f KB average, %.3f ms average, %llu damaged)",
+			loaded, loaded ? m_BytesRead / kilo_byte / loaded : 0.0f, loaded ? m_LoadTimeNs / 1e6 / loaded : 0.0, (uint64_t)m_LoadFailures);
+		ImGui::Text("Saved whole chunks: %llu (%.1f KB average)", snapshots, snapshots ? m_SnapshotBytes / kilo_byte / snapshots : 0.0f);
+		ImGui::Text("Saved chunk edits: %llu (%.1f B average), unedited chunks skipped: %llu", edits, edits ? (float)m_EditBytes / edits : 0.0f, (uint64_t)m_SkippedChunks);
+		ImGui::Text("Chunks prefetched ahead of the player: %llu", (uint64_t)m_PrefetchedChunks);
+		ImGui::Text("Chunks waiting to be written: %zu, loaded before they were written: %llu", GetPendingCount(), (uint64_t)m_RestoredChunks);
+#endif
+	}
+
+}
@@ -0,0 +1,170 @@
+///
+/// @file ChunkStorage.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkStorage class, which saves chunks
+///        of a world to region files and loads them back.
+///
+/// @details Chunks are grouped by RegionFile::GetRegionCoord, every region is a file named r.<x>.<z>.kcr
+///          in the region directory of the world. Opened regions are cached, regions not used by any
+///          thread are closed once too many are open. Loading a chunk decodes its block runs straight from
+///          the memory mapped region, much cheaper than generating it again. Regions are mapped without
+///          automatic read-ahead, chunks ahead of the moving player are prefetched instead.
+///          Saving is split in two: the main thread queues cheap snapshots of modified chunks and the save
+///          thread encodes and writes them later, so saving never stalls a frame.
+///
+/// @thread_safety Thread-safe, chunks are loaded by worker threads, queued by the main thread
+///                and written by the save thread.
+///
+
+#pragma once
+
+#include "World/Chunk/RegionFile.h"
+
+namespace KuchCraft {
+
+	class Chunk;
+	struct ChunkSaveSnapshot;
+
+	/// How a chunk was found in the storage.
+	enum class ChunkLoadResult : uint8_t
+	{
+		/// Not saved or damaged, the chunk has to be generated.
+		NotSaved,
+
+		/// Loaded whole, nothing has to be generated.
+		Snapshot,
+
+		/// Only edits were loaded, the chunk has to be generated and the edits applied.
+		Edits
+	};
+
+	/// Results of comparing memory mapped and stream reads of the chunks a player flying in a straight line loads
+	struct ChunkStorageReadBenchmark
+	{
+		bool     Done = false;
+		uint32_t Chunks = 0;
+		size_t   Bytes  = 0;
+		double   MappedMs   = 0.0;
+		double   BufferedMs = 0.0;
+	};
+
+	class ChunkStorage
+	{
+	public:
+		ChunkStorage() = default;
+
+		~ChunkStorage() = default;
+
+		ChunkStorage(const ChunkStorage&) = delete;
+		ChunkStorage& operator=(const ChunkStorage&) = delete;
+
+		/// Sets the directory region files are kept in and closes regions of the previous one.
+		/// An empty path disables loading and saving.
+		/// @param directory - the region directory.
+		void SetDirectory(const std::filesystem::path& directory);
+
+		/// Fills a chunk that was not built yet with its saved blocks or edits.
+		/// @param chunk - the chunk to fill.
+		/// @return What was loaded.
+		ChunkLoadResult Load(Chunk* chunk);
+
+		/// Queues a chunk snapshot to be written by WritePending(), replacing a queued snapshot of the same chunk.
+		/// Until it is written the chunk is loaded from the snapshot.
+		/// @param snapshot - the snapshot, see Chunk::CreateSaveSnapshot.
+		void QueueSave(std::shared_ptr<const ChunkSaveSnapshot> snapshot);
+
+		/// Writes queued snapshots to their region files, creating the files if needed. Snapshots storing
+		/// only edits are not stored at all when there are none, the chunk is generated again when loaded.
+		/// Written region files are synced, see RegionFile::Sync.
+		/// Must be called from one thread at a time, usually the save thread.
+		/// @return True if every snapshot was written, failed ones stay queued.
+		bool WritePending();
+
+		/// Retrieves the number of snapshots waiting to be written.
+		[[nodiscard]] size_t GetPendingCount() const;
+
+		/// Prefetches saved chunks the player is heading towards, so they are in memory once they are loaded.
+		/// @param center - the chunk the player entered.
+		/// @param direction - the direction of travel in chunks, nothing is prefetched if it is zero.
+		/// @param radius - the radius of the disc of loaded chunks.
+		void PrefetchAhead(const glm::ivec2& center, const glm::vec2& direction, int radius);
+
+		/// Reads and decodes the saved chunks loaded during a straight flight, once through the mappings
+		/// and once through file streams. Both runs read from the page cache warmed up by a first pass.
+		/// @param start - the chunk the flight starts in.
+		/// @param direction - the direction of the flight.
+		/// @param radius - the radius of the disc of loaded chunks.
+		/// @param distance - the length of the flight in chunks.
+		/// @return The results, Chunks is zero if none of the chunks was saved.
+		ChunkStorageReadBenchmark RunReadBenchmark(const glm::ivec2& start, const glm::vec2& direction, int radius, int distance);
+
+		/// Renders the storage stats.
+		void RenderImGui() const;
+
+	private:
+		/// Retrieves an opened region file.
+		/// @param regionCoord - the region coordinate.
+		/// @param create - whether a missing file is created.
+		/// @return The region, or nullptr if it does not exist and is not created.
+		std::shared_ptr<RegionFile> GetRegion(const glm::ivec2& regionCoord, bool create);
+
+		/// Encodes and writes a snapshot.
+		/// @param snapshot - the snapshot to write.
+		/// @param region - receives the region written to, nullptr if nothing was written.
+		/// @return True if the snapshot was written or did not need to be.
+		bool Write(const ChunkSaveSnapshot& snapshot, std::shared_ptr<RegionFile>& region);
+
+		/// Packs a region or chunk coordinate into a map key.
+		static inline [[nodiscard]] uint64_t GetCoordKey(const glm::ivec2& coord)
+		{
+			return (uint64_t)(uint32_t)coord.x << 32 | (uint32_t)coord.y;
+		}
+
+	private:
+		/// Directory region files are kept in.
+		std::filesystem::path m_Directory;
+
+		/// Opened regions, nullptr marks a region without a file so it is not looked up on every load.
+		std::unordered_map<uint64_t, std::shared_ptr<RegionFile>> m_Regions;
+
+		mutable std::mutex m_RegionsMutex;
+
+		/// Whether the directory is set, read by the main thread without locking the region cache.
+		std::atomic<bool> m_HasDirectory = false;
+
+		/// Snapshots waiting to be written by chunk coordinate.
+		std::unordered_map<uint64_t, std::shared_ptr<const ChunkSaveSnapshot>> m_Pending;
+
+		mutable std::mutex m_PendingMutex;
+
+		/// Regions written by WritePending() whose last sync failed or has not run yet, used by the save thread only.
+		std::vector<std::shared_ptr<RegionFile>> m_UnsyncedRegions;
+
+		/// Number of loaded chunks and of saved chunks that failed to load.
+		std::atomic<uint64_t> m_LoadedChunks = 0;
+		std::atomic<uint64_t> m_LoadFailures = 0;
+
+		/// Number of chunks saved whole, saved as edits and not saved because nothing had to be stored.
+		std::atomic<uint64_t> m_SavedSnapshots = 0;
+		std::atomic<uint64_t> m_SavedEdits     = 0;
+		std::atomic<uint64_t> m_SkippedChunks  = 0;
+
+		/// Number of payload bytes read, and written for whole chunks and for edits.
+		std::atomic<uint64_t> m_BytesRead     = 0;
+		std::atomic<uint64_t> m_SnapshotBytes = 0;
+		std::atomic<uint64_t> m_EditBytes     = 0;
+
+		/// Total time spent loading chunks in nanoseconds.
+		std::atomic<uint64_t> m_LoadTimeNs = 0;
+
+		/// Number of chunks loaded from snapshots that were not written yet.
+		std::atomic<uint64_t> m_RestoredChunks = 0;
+
+		/// Number of saved chunks prefetched ahead of the player.
+		std::atomic<uint64_t> m_PrefetchedChunks = 0;
+
+	};
+
+}
@@ -0,0 +1,80 @@
+///
+/// @file ChunkWorkQueue.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkWorkQueue class, a priority queue of chunk
+///        coordinates waiting for generation or meshing.
+///
+/// @details Entries are kept in a binary heap ordered by a priority value computed from the distance to the player,
+///          the view direction and the movement direction. Reprioritize() recomputes every priority at once when
+///          the player enters another chunk or turns, stale entries are dropped by the caller when popped.
+///
+/// @thread_safety Not thread-safe, used by the main thread only.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	/// Queue of chunk coordinates waiting for generation or meshing, the entry with the lowest priority value is taken first.
+	/// Priorities depend on the player position, so they can be recomputed for all entries when it changes.
+	class ChunkWorkQueue
+	{
+	public:
+		ChunkWorkQueue() = default;
+
+		~ChunkWorkQueue() = default;
+
+		/// Adds a chunk coordinate
+		/// @param coord - the chunk coordinate.
+		/// @param priority - lower values are taken first.
+		void Push(const glm::ivec2& coord, float priority)
+		{
+			m_Entries.push_back({ priority, coord });
+			std::push_heap(m_Entries.begin(), m_Entries.end(), Compare);
+		}
+
+		/// Removes and returns the coordinate with the lowest priority value, the queue must not be empty
+		glm::ivec2 Pop()
+		{
+			std::pop_heap(m_Entries.begin(), m_Entries.end(), Compare);
+			glm::ivec2 coord = m_Entries.back().Coord;
+			m_Entries.pop_back();
+			return coord;
+		}
+
+		/// Recomputes the priority of every entry and restores the heap order
+		/// @param priorityFunction - callable taking const glm::ivec2& and returning float.
+		template<typename Function>
+		void Reprioritize(Function&& priorityFunction)
+		{
+			for (auto& entry : m_Entries)
+				entry.Priority = priorityFunction(entry.Coord);
+
+			std::make_heap(m_Entries.begin(), m_Entries.end(), Compare);
+		}
+
+		/// Checks if the queue is empty
+		[[nodiscard]] bool IsEmpty() const { return m_Entries.empty(); }
+
+		/// Retrieves the number of queued coordinates
+		[[nodiscard]] uint32_t GetSize() const { return (uint32_t)m_Entries.size(); }
+
+	private:
+		struct Entry
+		{
+			float      Priority;
+			glm::ivec2 Coord;
+		};
+
+		/// Heap ordering, std heap functions keep the greatest element first so the comparison is reversed
+		static bool Compare(const Entry& a, const Entry& b) { return a.Priority > b.Priority; }
+
+	private:
+		/// Entries kept in heap order
+		std::vector<Entry> m_Entries;
+
+	};
+
+}
@@ -0,0 +1,212 @@
+///
+/// @file PalettedContainer.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/PalettedContainer.h"
+
+namespace KuchCraft {
+
+	PalettedContainer::PalettedContainer(uint32_t size, const Item& value)
+		: m_Size(size)
+	{
+		Fill(value);
+	}
+
+	void PalettedContainer::Set(uint32_t index, const Item& item)
+	{
+		uint32_t oldPaletteIndex = GetPaletteIndex(index);
+		if (m_Palette[oldPaletteIndex] == item)
+			return;
+
+		uint32_t newPaletteIndex = AcquirePaletteIndex(item);
+		SetPaletteIndex(index, newPaletteIndex);
+
+		if (m_ReferenceCounts[newPaletteIndex]++ == 0)
+			m_UsedPaletteEntries++;
+
+		if (--m_ReferenceCounts[oldPaletteIndex] == 0)
+		{
+			m_UsedPaletteEntries--;
+
+			/// Shrink only when the palette fits in half of the smaller width, so writes
+			/// alternating around a width boundary do not repack the container every time
+			uint32_t bitsPerEntry = m_UsedPaletteEntries == 1 ? 0 : GetBitsForPaletteSize(m_UsedPaletteEntries * 2);
+			if (bitsPerEntry < m_BitsPerEntry)
+				Resize(bitsPerEntry, true);
+		}
+	}
+
+	void PalettedContainer::Fill(const Item& item)
+	{
+		m_BitsPerEntry       = 0;
+		m_Mask               = 0;
+		m_UsedPaletteEntries = 1;
+
+		m_Words.clear();
+		m_Words.shrink_to_fit();
+
+		m_Palette        .assign(1, item);
+		m_ReferenceCounts.assign(1, m_Size);
+	}
+
+	void PalettedContainer::Pack(const Item* input)
+	{
+		/// Neighboring entries usually hold the same item, so the last found palette index is checked first
+		uint32_t lastIndex = 0;
+		auto findPaletteIndex = [&](const Item& item) {
+			if (lastIndex < m_Palette.size() && m_Palette[lastIndex] == item)
+				return lastIndex;
+
+			for (lastIndex = 0; lastIndex < (uint32_t)m_Palette.size(); lastIndex++)
+			{
+				if (m_Palette[lastIndex] == item)
+					return lastIndex;
+			}
+
+			m_Palette        .push_back(item);
+			m_ReferenceCounts.push_back(0);
+			return lastIndex;
+		};
+
+		m_Palette        .clear();
+		m_ReferenceCounts.clear();
+
+		for (uint32_t i = 0; i < m_Size; i++)
+			m_ReferenceCounts[findPaletteIndex(input[i])]++;
+
+		if (m_Palette.size() <= 1)
+		{
+			Fill(m_Palette.empty() ? Item() : m_Palette[0]);
+			return;
+		}
+
+		m_UsedPaletteEntries = (uint32_t)m_Palette.size();
+		m_BitsPerEntry       = GetBitsForPaletteSize(m_UsedPaletteEntries);
+		m_Mask               = (1u << m_BitsPerEntry) - 1;
+
+		m_Words.assign(((size_t)m_Size * m_BitsPerEntry + 63) / 64, 0);
+		for (uint32_t i = 0; i < m_Size; i++)
+		{
+			uint32_t bit = i * m_BitsPerEntry;
+			m_Words[bit >> 6] |= (uint64_t)findPaletteIndex(input[i]) << (bit & 63);
+		}
+	}
+
+	void PalettedContainer::Unpack(Item* output) const
+	{
+		if (m_BitsPerEntry == 0)
+		{
+			std::fill(output, output + m_Size, m_Palette[0]);
+			return;
+		}
+
+		for (uint32_t i = 0; i < m_Size; i++)
+			output[i] = m_Palette[GetPaletteIndex(i)];
+	}
+
+	size_t PalettedContainer::GetMemoryUsage() const
+	{
+		return sizeof(PalettedContainer) +
+			m_Words          .capacity() * sizeof(uint64_t) +
+			m_Palette        .capacity() * sizeof(Item) +
+			m_ReferenceCounts.capacity() * sizeof(uint32_t);
+	}
+
+	void PalettedContainer::SetPaletteIndex(uint32_t index, uint32_t paletteIndex)
+	{
+		uint32_t bit   = index * m_BitsPerEntry;
+		uint32_t shift = bit & 63;
+		uint64_t& word = m_Words[bit >> 6];
+
+		word = (word & ~((uint64_t)m_Mask << shift)) | ((uint64_t)paletteIndex << shift);
+	}
+
+	uint32_t PalettedContainer::AcquirePaletteIndex(const Item& item)
+	{
+		/// Chunks rarely hold more than a few distinct items, so a linear search beats any lookup structure here
+		uint32_t freeIndex = (uint32_t)m_Palette.size();
+		for (uint32_t i = 0; i < (uint32_t)m_Palette.size(); i++)
+		{
+			if (m_ReferenceCounts[i] == 0)
+				freeIndex = std::min(freeIndex, i);
+			else if (m_Palette[i] == item)
+				return i;
+		}
+
+		if (freeIndex < m_Palette.size())
+		{
+			m_Palette[freeIndex] = item;
+			return freeIndex;
+		}
+
+		m_Palette        .push_back(item);
+		m_ReferenceCounts.push_back(0);
+
+		uint32_t bitsPerEntry = GetBitsForPaletteSize((uint32_t)m_Palette.size());
+		if (bitsPerEntry > m_BitsPerEntry)
+			Resize(bitsPerEntry, false);
+
+		return freeIndex;
+	}
+
+	void PalettedContainer::Resize(uint32_t bitsPerEntry, bool compact)
+	{
+		std::vector<uint32_t> remap(m_Palette.size());
+		for (uint32_t i = 0; i < (uint32_t)remap.size(); i++)
+			remap[i] = i;
+
+		if (compact)
+		{
+			std::vector<Item>     palette;
+			std::vector<uint32_t> referenceCounts;
+			palette        .reserve(m_UsedPaletteEntries);
+			referenceCounts.reserve(m_UsedPaletteEntries);
+
+			for (uint32_t i = 0; i < (uint32_t)m_Palette.size(); i++)
+			{
+				if (m_ReferenceCounts[i] == 0)
+					continue;
+
+				remap[i] = (uint32_t)palette.size();
+				palette        .push_back(m_Palette[i]);
+				referenceCounts.push_back(m_ReferenceCounts[i]);
+			}
+
+			m_Palette         = std::move(palette);
+			m_ReferenceCounts = std::move(referenceCounts);
+		}
+
+		std::vector<uint64_t> words;
+		if (bitsPerEntry > 0)
+		{
+			words.resize(((size_t)m_Size * bitsPerEntry + 63) / 64, 0);
+			for (uint32_t i = 0; i < m_Size; i++)
+			{
+				uint32_t bit = i * bitsPerEntry;
+				words[bit >> 6] |= (uint64_t)remap[GetPaletteIndex(i)] << (bit & 63);
+			}
+		}
+
+		m_Words        = std::move(words);
+		m_BitsPerEntry = bitsPerEntry;
+		m_Mask         = bitsPerEntry > 0 ? (1u << bitsPerEntry) - 1 : 0;
+	}
+
+	uint32_t PalettedContainer::GetBitsForPaletteSize(uint32_t paletteSize)
+	{
+		if (paletteSize <= 1)
+			return 0;
+
+		for (uint32_t bitsPerEntry : { 1u, 2u, 4u, 8u })
+		{
+			if ((1u << bitsPerEntry) >= paletteSize)
+				return bitsPerEntry;
+		}
+
+		return 16;
+	}
+
+}
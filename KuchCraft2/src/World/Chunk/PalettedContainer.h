@@ -0,0 +1,120 @@
+///
+/// @file PalettedContainer.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the PalettedContainer class, a compressed
+///        fixed-size array of items.
+///
+/// @details Every distinct item is stored once in a palette, entries only keep an index into it.
+///          Indices are packed into 64-bit words using 0, 1, 2, 4, 8 or 16 bits per entry, so an entry
+///          never spans two words. The width grows when the palette overflows and shrinks when enough
+///          palette entries become unused. Zero bits means the whole container holds a single item.
+///
+/// @thread_safety Not thread-safe, concurrent reads are safe as long as nobody writes.
+///
+
+#pragma once
+
+#include "World/Item/Item.h"
+
+namespace KuchCraft {
+
+	class PalettedContainer
+	{
+	public:
+		/// Creates a container filled with a single item.
+		/// @param size - the number of entries.
+		/// @param value - the initial value of every entry.
+		PalettedContainer(uint32_t size, const Item& value = Item());
+
+		~PalettedContainer() = default;
+
+		/// Retrieves an entry.
+		/// @param index - the entry index, must be lower than GetSize().
+		/// @return The item stored at the index.
+		inline [[nodiscard]] const Item& Get(uint32_t index) const { return m_Palette[GetPaletteIndex(index)]; }
+
+		/// Sets an entry, growing or shrinking the palette if needed.
+		/// @param index - the entry index, must be lower than GetSize().
+		/// @param item - the item to store.
+		void Set(uint32_t index, const Item& item);
+
+		/// Sets every entry to the same item, releasing the index storage.
+		/// @param item - the item to store.
+		void Fill(const Item& item);
+
+		/// Replaces all entries with the items of a dense array, building the palette and indices in one go.
+		/// @param input - the array with at least GetSize() elements.
+		void Pack(const Item* input);
+
+		/// Decodes all entries into a dense array.
+		/// @param output - the array with at least GetSize() elements.
+		void Unpack(Item* output) const;
+
+		/// Retrieves the number of entries.
+		inline [[nodiscard]] uint32_t GetSize() const { return m_Size; }
+
+		/// Retrieves the current number of bits used per entry.
+		inline [[nodiscard]] uint32_t GetBitsPerEntry() const { return m_BitsPerEntry; }
+
+		/// Retrieves the number of distinct items currently stored.
+		inline [[nodiscard]] uint32_t GetPaletteSize() const { return m_UsedPaletteEntries; }
+
+		/// Checks if every entry holds the same item.
+		inline [[nodiscard]] bool IsUniform() const { return m_UsedPaletteEntries == 1; }
+
+		/// Retrieves the approximate number of bytes allocated by the container.
+		[[nodiscard]] size_t GetMemoryUsage() const;
+
+	private:
+		/// Reads the palette index of an entry.
+		inline [[nodiscard]] uint32_t GetPaletteIndex(uint32_t index) const
+		{
+			if (m_BitsPerEntry == 0)
+				return 0;
+
+			uint32_t bit = index * m_BitsPerEntry;
+			return (uint32_t)(m_Words[bit >> 6] >> (bit & 63)) & m_Mask;
+		}
+
+		/// Writes the palette index of an entry.
+		void SetPaletteIndex(uint32_t index, uint32_t paletteIndex);
+
+		/// Finds the palette index of an item or adds it to the palette.
+		/// @return The palette index.
+		uint32_t AcquirePaletteIndex(const Item& item);
+
+		/// Repacks all entries with a different number of bits, compacting the palette if requested.
+		/// @param bitsPerEntry - the new number of bits per entry.
+		/// @param compact - whether unused palette entries should be removed.
+		void Resize(uint32_t bitsPerEntry, bool compact);
+
+		/// Retrieves the smallest supported number of bits able to address a given number of palette entries.
+		static [[nodiscard]] uint32_t GetBitsForPaletteSize(uint32_t paletteSize);
+
+	private:
+		/// Number of entries.
+		uint32_t m_Size = 0;
+
+		/// Number of bits used by a single entry (0, 1, 2, 4, 8 or 16).
+		uint32_t m_BitsPerEntry = 0;
+
+		/// Mask of a single entry.
+		uint32_t m_Mask = 0;
+
+		/// Number of palette entries with a reference count above zero.
+		uint32_t m_UsedPaletteEntries = 0;
+
+		/// Packed palette indices.
+		std::vector<uint64_t> m_Words;
+
+		/// Distinct items, entries with zero references are reused before the palette grows.
+		std::vector<Item> m_Palette;
+
+		/// Number of entries referencing each palette item.
+		std::vector<uint32_t> m_ReferenceCounts;
+
+	};
+
+}
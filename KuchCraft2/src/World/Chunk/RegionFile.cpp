@@ -0,0 +1,374 @@
+///
+/// @file RegionFile.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/Chunk/RegionFile.h"
+
+#include "Core/FileSystem.h"
+
+namespace KuchCraft {
+
+	/// Sectors taken by the location table and the timestamps.
+	constexpr uint32_t region_header_sectors = 2;
+
+	/// Size of the record header: payload size, compression type and checksum.
+	constexpr uint32_t region_record_header_size = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+
+	/// The location table keeps the sector count of a record in 8 bits.
+	constexpr uint32_t region_max_record_sectors = 255;
+
+	static_assert(region_chunk_count * sizeof(uint32_t) == region_sector_size, "Location table must fill exactly one sector");
+
+	/// Lookup table of the reflected CRC32 polynomial.
+	static constexpr std::array<uint32_t, 256> crc32_table = []() {
+		std::array<uint32_t, 256> table = {};
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0u);
+
+			table[i] = crc;
+		}
+		return table;
+	}();
+
+	uint32_t RegionFile::Crc32(const uint8_t* data, size_t size)
+	{
+		uint32_t crc = 0xFFFFFFFFu;
+		for (size_t i = 0; i < size; i++)
+			crc = crc32_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	RegionFile::RegionFile(const std::filesystem::path& path, bool create)
+		: m_Path(path)
+	{
+		std::error_code error;
+		bool exists = std::filesystem::exists(path, error);
+		if (!exists && !create)
+			return;
+
+		if (!exists)
+		{
+			std::filesystem::create_directories(path.parent_path(), error);
+
+			/// Empty header, no chunk is stored
+			std::ofstream newFile(path, std::ios::binary);
+			std::vector<char> header(region_header_sectors * region_sector_size, 0);
+			newFile.write(header.data(), header.size());
+			if (!newFile)
+			{
+				Log::Error("[Region File] : Failed to create : {}", path.string());
+				return;
+			}
+		}
+
+		m_File.open(path, std::ios::binary | std::ios::in | std::ios::out);
+		if (!m_File.is_open())
+		{
+			Log::Error("[Region File] : Failed to open : {}", path.string());
+			return;
+		}
+
+		m_File.read(reinterpret_cast<char*>(m_Locations.data()),  sizeof(m_Locations));
+		m_File.read(reinterpret_cast<char*>(m_Timestamps.data()), sizeof(m_Timestamps));
+		if (!m_File)
+		{
+			Log::Error("[Region File] : Invalid header : {}", path.string());
+			m_File.close();
+			return;
+		}
+
+		uint64_t fileSize = std::filesystem::file_size(path, error);
+		m_UsedSectors.assign((size_t)std::max<uint64_t>((fileSize + region_sector_size - 1) / region_sector_size, region_header_sectors), false);
+		SetSectorsUsed(0, region_header_sectors, true);
+
+		/// Records pointing outside of the file or into the header are dropped, the chunks are generated again
+		for (uint32_t i = 0; i < region_chunk_count; i++)
+		{
+			uint32_t first = m_Locations[i] >> 8;
+			uint32_t count = m_Locations[i] & 0xFF;
+			if (m_Locations[i] == 0)
+				continue;
+
+			if (first < region_header_sectors || count == 0 || first + count > m_UsedSectors.size())
+			{
+				Log::Warn("[Region File] : Invalid location of chunk {} in : {}", i, path.string());
+				m_Locations[i] = 0;
+				continue;
+			}
+
+			SetSectorsUsed(first, count, true);
+		}
+
+		/// Without the mapping chunks can still be saved, they are only not loaded
+		m_Mapping.Open(path);
+
+		m_Open = true;
+	}
+
+	RegionFile::~RegionFile()
+	{
+		if (m_Open && !m_UnsyncedLocations.empty())
+			Sync();
+	}
+
+	bool RegionFile::Contains(const glm::ivec2& localCoord)
+	{
+		std::shared_lock lock(m_Mutex);
+		return m_Open && m_Locations[GetIndex(localCoord)] != 0;
+	}
+
+	bool RegionFile::MapRecord(const glm::ivec2& localCoord, std::shared_lock<std::shared_mutex>& lock, RecordView& record)
+	{
+		if (!m_Open)
+			return false;
+
+		uint32_t location = m_Locations[GetIndex(localCoord)];
+		if (location == 0)
+			return false;
+
+		/// Records appended after the file was mapped need a new mapping, the location is read again
+		/// because a write could move the record while no lock was held
+		if ((size_t)((location >> 8) + (location & 0xFF)) * region_sector_size > m_Mapping.GetSize())
+		{
+			lock.unlock();
+			{
+				std::unique_lock writeLock(m_Mutex);
+				m_Mapping.Open(m_Path);
+			}
+			lock.lock();
+
+			location = m_Locations[GetIndex(localCoord)];
+			if (location == 0)
+				return false;
+		}
+
+		size_t offset = (size_t)(location >> 8) * region_sector_size;
+		size_t end    = (size_t)((location >> 8) + (location & 0xFF)) * region_sector_size;
+		if (end > m_Mapping.GetSize())
+		{
+			Log::Error("[Region File] : Chunk ({}, {}) is outside of the mapped file", localCoord.x, localCoord.y);
+			return false;
+		}
+
+		const uint8_t* data     = m_Mapping.GetData() + offset;
+		uint32_t       size     = 0;
+		uint8_t        type     = 0;
+		uint32_t       checksum = 0;
+		std::memcpy(&size,     data,                               sizeof(size));
+		std::memcpy(&type,     data + sizeof(size),                sizeof(type));
+		std::memcpy(&checksum, data + sizeof(size) + sizeof(type), sizeof(checksum));
+
+		if (size > end - offset - region_record_header_size)
+		{
+			Log::Error("[Region File] : Invalid record header of chunk ({}, {})", localCoord.x, localCoord.y);
+			return false;
+		}
+
+		record.Payload     = data + region_record_header_size;
+		record.Size        = size;
+		record.Compression = (RegionCompression)type;
+
+		if (Crc32(record.Payload, record.Size) != checksum)
+		{
+			Log::Error("[Region File] : Checksum mismatch of chunk ({}, {})", localCoord.x, localCoord.y);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool RegionFile::Prefetch(const glm::ivec2& localCoord)
+	{
+		std::shared_lock lock(m_Mutex);
+
+		uint32_t location = m_Open ? m_Locations[GetIndex(localCoord)] : 0;
+		if (location == 0)
+			return false;
+
+		m_Mapping.Prefetch((size_t)(location >> 8) * region_sector_size, (size_t)(location & 0xFF) * region_sector_size);
+		return true;
+	}
+
+	bool RegionFile::ReadBuffered(const glm::ivec2& localCoord, RegionCompression& compression, std::vector<uint8_t>& payload)
+	{
+		/// The file stream position is shared, so stream reads are exclusive
+		std::unique_lock lock(m_Mutex);
+
+		if (!m_Open)
+			return false;
+
+		uint32_t location = m_Locations[GetIndex(localCoord)];
+		if (location == 0)
+			return false;
+
+		uint32_t first = location >> 8;
+		uint32_t count = location & 0xFF;
+
+		uint32_t size     = 0;
+		uint8_t  type     = 0;
+		uint32_t checksum = 0;
+
+		m_File.clear();
+		m_File.seekg((std::streamoff)first * region_sector_size);
+		m_File.read(reinterpret_cast<char*>(&size),     sizeof(size));
+		m_File.read(reinterpret_cast<char*>(&type),     sizeof(type));
+		m_File.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+
+		if (!m_File || size > count * region_sector_size - region_record_header_size)
+		{
+			Log::Error("[Region File] : Invalid record header of chunk ({}, {})", localCoord.x, localCoord.y);
+			return false;
+		}
+
+		payload.resize(size);
+		m_File.read(reinterpret_cast<char*>(payload.data()), size);
+
+		if (!m_File || Crc32(payload.data(), payload.size()) != checksum)
+		{
+			Log::Error("[Region File] : Checksum mismatch of chunk ({}, {})", localCoord.x, localCoord.y);
+			return false;
+		}
+
+		compression = (RegionCompression)type;
+		return true;
+	}
+
+	bool RegionFile::Write(const glm::ivec2& localCoord, RegionCompression compression, const uint8_t* payload, size_t size)
+	{
+		std::unique_lock lock(m_Mutex);
+
+		if (!m_Open)
+			return false;
+
+		uint32_t sectors = (uint32_t)((size + region_record_header_size + region_sector_size - 1) / region_sector_size);
+		if (sectors > region_max_record_sectors)
+		{
+			Log::Error("[Region File] : Chunk ({}, {}) is too large to be saved : {} bytes", localCoord.x, localCoord.y, size);
+			return false;
+		}
+
+		/// The current record stays marked as used, so the new one never overwrites it
+		uint32_t index = GetIndex(localCoord);
+		uint32_t first = FindFreeSectors(sectors);
+		SetSectorsUsed(first, sectors, true);
+
+		uint32_t checksum = Crc32(payload, size);
+		uint32_t size32   = (uint32_t)size;
+		uint8_t  type     = (uint8_t)compression;
+
+		/// Records are padded to whole sectors, so the file always ends at a sector boundary
+		size_t padding = (size_t)sectors * region_sector_size - region_record_header_size - size;
+		static const std::vector<char> zeros(region_sector_size, 0);
+
+		m_File.clear();
+		m_File.seekp((std::streamoff)first * region_sector_size);
+		m_File.write(reinterpret_cast<const char*>(&size32),   sizeof(size32));
+		m_File.write(reinterpret_cast<const char*>(&type),     sizeof(type));
+		m_File.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+		m_File.write(reinterpret_cast<const char*>(payload),   size);
+		m_File.write(zeros.data(), padding);
+		m_File.flush();
+
+		if (!m_File)
+		{
+			Log::Error("[Region File] : Failed to write chunk ({}, {})", localCoord.x, localCoord.y);
+			SetSectorsUsed(first, sectors, false);
+			return false;
+		}
+
+		/// Only the location in memory changes, Sync() writes it once the record is on the disk
+		uint32_t& location = m_Locations[index];
+		if (location != 0)
+			m_ReplacedRecords.push_back({ location >> 8, location & 0xFF });
+
+		if (std::find(m_UnsyncedLocations.begin(), m_UnsyncedLocations.end(), index) == m_UnsyncedLocations.end())
+			m_UnsyncedLocations.push_back(index);
+
+		location = first << 8 | sectors;
+		m_Timestamps[index] = (uint32_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		return true;
+	}
+
+	bool RegionFile::Sync()
+	{
+		std::unique_lock lock(m_Mutex);
+
+		if (!m_Open)
+			return false;
+
+		if (m_UnsyncedLocations.empty())
+			return true;
+
+		/// Records have to be on the disk before anything points at them
+		m_File.clear();
+		m_File.flush();
+		if (!m_File || !FileSystem::Sync(m_Path))
+			return false;
+
+		for (uint32_t index : m_UnsyncedLocations)
+		{
+			m_File.seekp((std::streamoff)index * sizeof(uint32_t));
+			m_File.write(reinterpret_cast<const char*>(&m_Locations[index]), sizeof(uint32_t));
+			m_File.seekp((std::streamoff)region_sector_size + index * sizeof(uint32_t));
+			m_File.write(reinterpret_cast<const char*>(&m_Timestamps[index]), sizeof(uint32_t));
+		}
+		m_File.flush();
+
+		if (!m_File || !FileSystem::Sync(m_Path))
+		{
+			Log::Error("[Region File] : Failed to write chunk locations : {}", m_Path.string());
+			return false;
+		}
+
+		m_UnsyncedLocations.clear();
+
+		/// Nothing on the disk points at the replaced records anymore
+		for (const SectorRun& run : m_ReplacedRecords)
+			SetSectorsUsed(run.First, run.Count, false);
+
+		m_ReplacedRecords.clear();
+		return true;
+	}
+
+	void RegionFile::SetSectorsUsed(uint32_t first, uint32_t count, bool used)
+	{
+		if (first + count > m_UsedSectors.size())
+			m_UsedSectors.resize(first + count, false);
+
+		for (uint32_t i = first; i < first + count; i++)
+			m_UsedSectors[i] = used;
+	}
+
+	uint32_t RegionFile::FindFreeSectors(uint32_t count) const
+	{
+		uint32_t runStart  = 0;
+		uint32_t runLength = 0;
+
+		for (uint32_t i = region_header_sectors; i < (uint32_t)m_UsedSectors.size(); i++)
+		{
+			if (m_UsedSectors[i])
+			{
+				runLength = 0;
+				continue;
+			}
+
+			if (runLength == 0)
+				runStart = i;
+
+			if (++runLength == count)
+				return runStart;
+		}
+
+		/// A free run at the end of the file can be extended
+		return runLength > 0 ? runStart : (uint32_t)m_UsedSectors.size();
+	}
+
+}
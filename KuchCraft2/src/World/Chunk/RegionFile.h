@@ -0,0 +1,192 @@
+///
+/// @file RegionFile.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the RegionFile class, a single file storing
+///        the saved data of region_size x region_size chunks.
+///
+/// @details The file is split into sectors of region_sector_size bytes. The first sector holds the location
+///          table, one uint32 per chunk: the first sector of the chunk record in the upper 24 bits and the number
+///          of sectors it spans in the lower 8 bits, zero if the chunk is not stored. The second sector holds
+///          the time every chunk was last written. Chunk records start with a header: uint32 payload size,
+///          uint8 compression type and uint32 CRC32 of the payload, followed by the payload itself.
+///          Values are stored little-endian.
+///          A rewritten chunk always goes to free sectors, its current record is never overwritten. The new location is
+///          kept in memory until Sync(), which first flushes the new records to the disk and only then writes and flushes
+///          their locations. Sectors of replaced records are reused only after that, so a crash at any point leaves every
+///          location on the disk pointing at a complete record, either the previous or the new one.
+///          Records are read from a memory mapping of the file, so payloads are decoded straight from the page cache.
+///          Writes go through a regular file stream, the mapping is reopened once a record past its end is read.
+///
+/// @thread_safety Thread-safe, reads run in parallel, writes are exclusive.
+///
+
+#pragma once
+
+#include "Core/MappedFile.h"
+
+namespace KuchCraft {
+
+	/// Number of chunks along a side of a region, as a power of two.
+	inline constexpr int region_size_shift = 5;
+	inline constexpr int region_size       = 1 << region_size_shift;
+
+	/// Number of chunks in a region.
+	inline constexpr int region_chunk_count = region_size * region_size;
+
+	/// Size of a file sector in bytes.
+	inline constexpr uint32_t region_sector_size = 4096;
+
+	/// Ways the payload of a chunk record can be encoded.
+	enum class RegionCompression : uint8_t
+	{
+		/// Stored as is.
+		None = 0,
+
+		/// Runs of identical blocks, see ChunkSerializer.
+		BlockRuns = 1,
+
+		/// Runs of blocks that differ from the generated terrain, see ChunkSerializer.
+		BlockEdits = 2
+	};
+
+	class RegionFile
+	{
+	public:
+		/// Opens a region file, creating it if needed.
+		/// @param path - the path of the file.
+		/// @param create - whether a missing file is created, otherwise the region stays closed.
+		RegionFile(const std::filesystem::path& path, bool create);
+
+		/// Commits locations that were not synced yet.
+		~RegionFile();
+
+		RegionFile(const RegionFile&) = delete;
+		RegionFile& operator=(const RegionFile&) = delete;
+
+		/// Checks if the file was opened and its header is valid.
+		inline [[nodiscard]] bool IsOpen() const { return m_Open; }
+
+		/// Checks if a chunk is stored.
+		/// @param localCoord - the chunk coordinate inside the region, see GetLocalCoord.
+		[[nodiscard]] bool Contains(const glm::ivec2& localCoord);
+
+		/// Verifies the record of a chunk and passes its payload to a function without copying it.
+		/// The payload points into the mapping and is valid only during the call.
+		/// @param localCoord - the chunk coordinate inside the region, see GetLocalCoord.
+		/// @param function - callable taking (RegionCompression, const uint8_t* payload, size_t size) and returning bool.
+		/// @return True if the chunk is stored, its record is valid and the function succeeded.
+		template<typename Function>
+		bool Read(const glm::ivec2& localCoord, Function&& function)
+		{
+			std::shared_lock lock(m_Mutex);
+
+			RecordView record;
+			if (!MapRecord(localCoord, lock, record))
+				return false;
+
+			return function(record.Compression, record.Payload, (size_t)record.Size);
+		}
+
+		/// Reads the record of a chunk through the file stream and verifies its checksum.
+		/// Slower than Read(), kept to compare both ways of reading.
+		/// @param localCoord - the chunk coordinate inside the region, see GetLocalCoord.
+		/// @param compression - receives the compression type of the payload.
+		/// @param payload - receives the payload.
+		/// @return True if the chunk is stored and its record is valid.
+		bool ReadBuffered(const glm::ivec2& localCoord, RegionCompression& compression, std::vector<uint8_t>& payload);
+
+		/// Asks the system to read the record of a chunk into memory in the background.
+		/// @param localCoord - the chunk coordinate inside the region, see GetLocalCoord.
+		/// @return True if the chunk is stored.
+		bool Prefetch(const glm::ivec2& localCoord);
+
+		/// Writes the record of a chunk to free sectors, replacing the previous one in memory.
+		/// The replacement reaches the disk with the next Sync().
+		/// @param localCoord - the chunk coordinate inside the region, see GetLocalCoord.
+		/// @param compression - the compression type of the payload.
+		/// @param payload - the payload.
+		/// @param size - the payload size in bytes.
+		/// @return True if the record was written.
+		bool Write(const glm::ivec2& localCoord, RegionCompression compression, const uint8_t* payload, size_t size);
+
+		/// Flushes written records to the disk, then writes their locations and flushes those too.
+		/// Sectors of the replaced records are freed afterwards. Does nothing if nothing was written since the last call.
+		/// @return True if everything written reached the disk, on failure the next call tries again.
+		bool Sync();
+
+		/// Retrieves the number of sectors the file spans.
+		inline [[nodiscard]] uint32_t GetSectorCount() const { return (uint32_t)m_UsedSectors.size(); }
+
+		/// Converts a chunk coordinate to the coordinate of its region.
+		static inline [[nodiscard]] glm::ivec2 GetRegionCoord(const glm::ivec2& chunkCoord)
+		{
+			return { chunkCoord.x >> region_size_shift, chunkCoord.y >> region_size_shift };
+		}
+
+		/// Converts a chunk coordinate to its coordinate inside the region.
+		static inline [[nodiscard]] glm::ivec2 GetLocalCoord(const glm::ivec2& chunkCoord)
+		{
+			return { chunkCoord.x & (region_size - 1), chunkCoord.y & (region_size - 1) };
+		}
+
+		/// Calculates the CRC32 (IEEE 802.3) checksum of data.
+		static [[nodiscard]] uint32_t Crc32(const uint8_t* data, size_t size);
+
+	private:
+		/// Run of sectors taken by a chunk record.
+		struct SectorRun
+		{
+			uint32_t First = 0;
+			uint32_t Count = 0;
+		};
+
+		/// Record of a chunk inside the mapping.
+		struct RecordView
+		{
+			const uint8_t*    Payload     = nullptr;
+			uint32_t          Size        = 0;
+			RegionCompression Compression = RegionCompression::None;
+		};
+
+		/// Finds the record of a chunk in the mapping and verifies its checksum, remapping the file if the record is past its end.
+		/// @param localCoord - the chunk coordinate inside the region.
+		/// @param lock - the held shared lock, released for a moment while the file is remapped.
+		/// @param record - receives the record.
+		/// @return True if the chunk is stored and its record is valid.
+		bool MapRecord(const glm::ivec2& localCoord, std::shared_lock<std::shared_mutex>& lock, RecordView& record);
+
+		/// Marks sectors as used or free.
+		void SetSectorsUsed(uint32_t first, uint32_t count, bool used);
+
+		/// Finds the first run of free sectors, the end of the file if there is none.
+		[[nodiscard]] uint32_t FindFreeSectors(uint32_t count) const;
+
+		/// Retrieves the index of a chunk in the location table.
+		static inline [[nodiscard]] uint32_t GetIndex(const glm::ivec2& localCoord) { return (uint32_t)(localCoord.y * region_size + localCoord.x); }
+
+	private:
+		std::filesystem::path m_Path;
+		std::fstream          m_File;
+		MappedFile            m_Mapping;
+		bool                  m_Open = false;
+
+		/// Location table and write times loaded from the header.
+		std::array<uint32_t, region_chunk_count> m_Locations  = {};
+		std::array<uint32_t, region_chunk_count> m_Timestamps = {};
+
+		/// Which sectors of the file are used by the header or chunk records.
+		std::vector<bool> m_UsedSectors;
+
+		/// Chunks whose location changed in memory and was not written to the file yet.
+		std::vector<uint32_t> m_UnsyncedLocations;
+
+		/// Records replaced since the last Sync(), their sectors stay used until the new locations are on the disk.
+		std::vector<SectorRun> m_ReplacedRecords;
+
+		std::shared_mutex m_Mutex;
+
+	};
+
+}
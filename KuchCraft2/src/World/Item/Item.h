@@ -123,6 +123,9 @@ namespace KuchCraft {
 
 		~Item();
 
+		/// Compares items by their ID and flags.
+		inline [[nodiscard]] bool operator==(const Item& other) const { return m_ID == other.m_ID && m_Flags == other.m_Flags; }
+
 		/// Handles item usage logic.
 		void Use();
 
@@ -27,10 +27,22 @@ namespace KuchCraft {
 
 		uint32_t blockTextureSize = ApplicationConfig::GetRendererData().BlockTextureSize;
 		uint32_t itemCount        = 0;
+		ItemID   maxID            = 0;
 
 		for (const auto& item : json["Items"])
+		{
 			if (item.contains("id") && item["id"].get<int>())
+			{
 				itemCount++;
+				maxID = std::max(maxID, item["id"].get<ItemID>());
+			}
+		}
+
+		/// Every ID without an entry (including air) stays transparent, not solid and without texture
+		s_Transparent  .assign((size_t)maxID + 1, 1);
+		s_Solid        .assign((size_t)maxID + 1, 0);
+		s_TextureLayers.assign((size_t)maxID + 1, 0);
+		s_LightEmission.assign((size_t)maxID + 1, 0.0f);
 
 		TextureSpecification spec;
 		spec.Type    = TextureType::_2D_ARRAY;
@@ -194,10 +206,13 @@ namespace KuchCraft {
 				TextureManager::Add(texture2D, info.Name);
 
 				delete[] mergedData;
-				s_ItemTextureArrayLayers[ID] = layerIndex;
+				s_TextureLayers[ID] = (uint16_t)layerIndex;
 				layerIndex++;
 			}
-			
+
+			s_Transparent  [ID] = info.Transparent;
+			s_Solid        [ID] = info.Type == ItemType::Block;
+			s_LightEmission[ID] = info.LightEmission;
 		}
 
 		for (const auto& item : json["Items"])
@@ -12,9 +12,26 @@ namespace KuchCraft {
 		static void Reload();
 
 		/// Retrieves item information based on its ID.
+		/// Meant for descriptive data, hot paths should use the dense accessors below.
 		/// @param id The ID of the item.
-		/// @return A reference to the ItemInfo structure.
-		static const ItemInfo& GetInfo(ItemID id) { return s_Data[id]; }
+		/// @return A reference to the ItemInfo structure, default one for unknown IDs.
+		static const ItemInfo& GetInfo(ItemID id)
+		{
+			auto it = s_Data.find(id);
+			return it != s_Data.end() ? it->second : s_DefaultInfo;
+		}
+
+		/// Checks if the item lets neighboring faces be seen through it. Unknown IDs behave like air.
+		/// @param id The ID of the item.
+		static inline [[nodiscard]] bool IsTransparent(ItemID id) { return id < s_Transparent.size() ? s_Transparent[id] : true; }
+
+		/// Checks if the item is a full block. Unknown IDs behave like air.
+		/// @param id The ID of the item.
+		static inline [[nodiscard]] bool IsSolid(ItemID id) { return id < s_Solid.size() ? s_Solid[id] : false; }
+
+		/// Retrieves the amount of light emitted by the item.
+		/// @param id The ID of the item.
+		static inline [[nodiscard]] float GetLightEmission(ItemID id) { return id < s_LightEmission.size() ? s_LightEmission[id] : 0.0f; }
 
 		/// Retrieves all item informations
 		/// @return A reference to map of ItemInfo.
@@ -31,7 +48,9 @@ namespace KuchCraft {
 				return 0;
 		}
 
-		static const uint32_t GetTextureLayer(ItemID id) { return s_ItemTextureArrayLayers[id]; }
+		/// Retrieves the layer of the item texture array holding the item faces.
+		/// @param id The ID of the item.
+		static const uint32_t GetTextureLayer(ItemID id) { return id < s_TextureLayers.size() ? s_TextureLayers[id] : 0; }
 
 		static const std::shared_ptr<TextureArray>& GetTextureArray() { return s_ItemTextureArray; }
 
@@ -42,14 +61,21 @@ namespace KuchCraft {
 		/// Storage for item information.
 		static inline std::unordered_map<ItemID, ItemInfo> s_Data;
 
+		/// Returned for IDs without item information.
+		static inline const ItemInfo s_DefaultInfo;
+
 		/// Storage for item information.
 		static inline std::unordered_map<std::string, ItemID> s_NameData;
 
 		/// Stores all item textures
 		static inline std::shared_ptr<TextureArray> s_ItemTextureArray;
 
-		/// Maps item IDs to texture layers.
-		static inline std::unordered_map<ItemID, uint32_t>  s_ItemTextureArrayLayers;
+		/// Properties used while meshing and generating chunks, kept apart from ItemInfo in ItemID indexed arrays
+		/// so a lookup is a single load from a small, cache resident table.
+		static inline std::vector<uint8_t>  s_Transparent;
+		static inline std::vector<uint8_t>  s_Solid;
+		static inline std::vector<uint16_t> s_TextureLayers;
+		static inline std::vector<float>    s_LightEmission;
 
 	};
 
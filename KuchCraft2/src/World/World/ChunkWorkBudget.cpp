@@ -0,0 +1,81 @@
+///
+/// @file ChunkWorkBudget.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/World/ChunkWorkBudget.h"
+
+#ifdef  INCLUDE_IMGUI
+	#include <imgui.h>
+#endif
+
+namespace KuchCraft {
+
+	/// Weight of the newest sample in the moving averages
+	constexpr float budget_average_weight = 0.1f;
+
+	/// The budget never drops below this value
+	constexpr float min_budget_ms = 0.25f;
+
+	/// Budget change per frame when frames are too slow / fast enough
+	constexpr float budget_shrink_factor = 0.9f;
+	constexpr float budget_grow_step_ms  = 0.05f;
+
+	void ChunkWorkBudget::BeginFrame(float frameTimeMs, float maxBudgetMs, float targetFrameTimeMs)
+	{
+		m_BudgetTracker.AddValue(m_BudgetMs);
+		m_SpentTracker .AddValue(m_SpentMs);
+
+		m_LastFrameTaskCount = m_TaskCount;
+		m_TaskCount.fill(0);
+		m_SpentMs = 0.0f;
+
+		if (m_AverageFrameTimeMs == 0.0f)
+			m_AverageFrameTimeMs = frameTimeMs;
+		else
+			m_AverageFrameTimeMs += (frameTimeMs - m_AverageFrameTimeMs) * budget_average_weight;
+
+		/// Slow frames are not always caused by chunk work, so the budget only shrinks gradually
+		/// and is restored step by step once frames are fast again
+		if (m_AverageFrameTimeMs > targetFrameTimeMs)
+			m_BudgetMs *= budget_shrink_factor;
+		else
+			m_BudgetMs += budget_grow_step_ms;
+
+		m_BudgetMs = std::clamp(m_BudgetMs, std::min(min_budget_ms, maxBudgetMs), maxBudgetMs);
+	}
+
+	bool ChunkWorkBudget::CanAfford(ChunkTask task) const
+	{
+		bool firstTask = std::all_of(m_TaskCount.begin(), m_TaskCount.end(), [](uint32_t count) { return count == 0; });
+		return firstTask || m_SpentMs + m_TaskCostMs[(uint8_t)task] <= m_BudgetMs;
+	}
+
+	void ChunkWorkBudget::Record(ChunkTask task, Clock::time_point start)
+	{
+		float costMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+		float& average = m_TaskCostMs[(uint8_t)task];
+		average += (costMs - average) * budget_average_weight;
+
+		m_SpentMs += costMs;
+		m_TaskCount[(uint8_t)task]++;
+	}
+
+	void ChunkWorkBudget::RenderImGui()
+	{
+#ifdef  INCLUDE_IMGUI
+		ImGui::Text("Chunk work budget: %.2f ms, frame time: %.2f ms", m_BudgetMs, m_AverageFrameTimeMs);
+
+		constexpr const char* task_names[] = { "Generate", "Mesh", "Finish generate", "Finish mesh" };
+		for (uint8_t i = 0; i < (uint8_t)ChunkTask::Count; i++)
+			ImGui::Text("%-16s %3u tasks, %.3f ms each", task_names[i], m_LastFrameTaskCount[i], m_TaskCostMs[i]);
+
+		m_BudgetTracker.RenderImGui("Budget (ms)");
+		m_SpentTracker .RenderImGui("Spent (ms)");
+#endif
+	}
+
+}
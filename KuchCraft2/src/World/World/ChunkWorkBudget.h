@@ -0,0 +1,103 @@
+///
+/// @file ChunkWorkBudget.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the ChunkWorkBudget class, which limits
+///        the time the main thread spends on chunk work in a single frame.
+///
+/// @details The cost of every kind of chunk task is measured and averaged, a task is started only if its
+///          average cost still fits in the frame budget. The budget shrinks while frames are slower
+///          than the target frame time and grows back up to the configured maximum when they are faster.
+///          At least one task is allowed every frame so chunk work never stops completely.
+///
+
+#pragma once
+
+#include "Core/MetricTracker.h"
+
+namespace KuchCraft {
+
+	/// Kinds of main thread chunk work measured by the budget
+	enum class ChunkTask : uint8_t
+	{
+		/// Handing a chunk to a worker thread for generation
+		Generate = 0,
+
+		/// Taking a mesh snapshot and handing it to a worker thread
+		Mesh,
+
+		/// Marking a generated chunk as built and notifying its neighbors
+		FinishGenerate,
+
+		/// Publishing a finished mesh
+		FinishMesh,
+
+		Count
+	};
+
+	class ChunkWorkBudget
+	{
+	public:
+		using Clock = std::chrono::high_resolution_clock;
+
+		ChunkWorkBudget() = default;
+
+		~ChunkWorkBudget() = default;
+
+		/// Starts a new frame and adapts the budget to the recent frame times.
+		/// @param frameTimeMs - the duration of the previous frame.
+		/// @param maxBudgetMs - the upper limit of the budget.
+		/// @param targetFrameTimeMs - the frame time the budget adapts to.
+		void BeginFrame(float frameTimeMs, float maxBudgetMs, float targetFrameTimeMs);
+
+		/// Checks if a task of the given kind fits in what is left of the budget.
+		[[nodiscard]] bool CanAfford(ChunkTask task) const;
+
+		/// Records a finished task.
+		/// @param task - the kind of the task.
+		/// @param start - the time the task started at.
+		void Record(ChunkTask task, Clock::time_point start);
+
+		/// Retrieves the current budget.
+		inline [[nodiscard]] float GetBudgetMs() const { return m_BudgetMs; }
+
+		/// Retrieves the time spent on chunk work in the current frame.
+		inline [[nodiscard]] float GetSpentMs() const { return m_SpentMs; }
+
+		/// Retrieves the averaged frame time.
+		inline [[nodiscard]] float GetAverageFrameTimeMs() const { return m_AverageFrameTimeMs; }
+
+		/// Retrieves the averaged cost of a task.
+		inline [[nodiscard]] float GetTaskCostMs(ChunkTask task) const { return m_TaskCostMs[(uint8_t)task]; }
+
+		/// Retrieves the number of tasks of a kind done in the previous frame.
+		inline [[nodiscard]] uint32_t GetLastFrameTaskCount(ChunkTask task) const { return m_LastFrameTaskCount[(uint8_t)task]; }
+
+		/// Renders the budget stats and history.
+		void RenderImGui();
+
+	private:
+		/// Current budget for the frame.
+		float m_BudgetMs = 2.0f;
+
+		/// Time spent on chunk work in the current frame.
+		float m_SpentMs = 0.0f;
+
+		/// Exponential moving average of the frame time.
+		float m_AverageFrameTimeMs = 0.0f;
+
+		/// Exponential moving average of the cost of every task kind.
+		std::array<float, (size_t)ChunkTask::Count> m_TaskCostMs = { 0.05f, 0.3f, 0.02f, 0.02f };
+
+		/// Number of tasks of every kind done in the current and previous frame.
+		std::array<uint32_t, (size_t)ChunkTask::Count> m_TaskCount = {};
+		std::array<uint32_t, (size_t)ChunkTask::Count> m_LastFrameTaskCount = {};
+
+		/// History of the budget and the time spent.
+		MetricTracker<float, 500> m_BudgetTracker;
+		MetricTracker<float, 500> m_SpentTracker;
+
+	};
+
+}
@@ -13,11 +13,13 @@
 #include "World/World/WorldSerializer.h"
 
 #include "Core/Application.h"
+#include "Core/ThreadPool.h"
 #include "World/NativeScripts.h"
 #include "Graphics/Renderer.h"
 #include "Graphics/TextureManager.h"
 
 #include "World/Item/ItemMenager.h"
+#include "World/WorldGenerator/WorldGenerator.h"
 
 #include "Physics/ViewFrustum.h"
 
@@ -30,6 +32,18 @@
 
 namespace KuchCraft {
 
+	/// Number of chunk builds (and separately meshes) that can be scheduled for every worker thread
+	constexpr uint32_t chunk_jobs_per_worker = 2;
+
+	/// Priority added to chunks outside the view frustum, in chunks of distance
+	constexpr float chunk_offscreen_priority_penalty = 4.0f;
+
+	/// How much the movement direction shortens (ahead) or extends (behind) the distance of a chunk
+	constexpr float chunk_movement_priority_weight = 0.25f;
+
+	/// Cosine of the angle the camera has to turn by before queued chunks are prioritized again
+	constexpr float chunk_reprioritize_view_cos = 0.866f;
+
 	World::World()
 	{
 
@@ -38,6 +52,8 @@ namespace KuchCraft {
 	World::World(const std::filesystem::path& path)
 		: m_Path(path)
 	{
+		m_ChunkStorage.SetDirectory(m_Path / ApplicationConfig::GetWorldData().RegionDirectory);
+
 		WorldSerializer serializer(this);
 		serializer.Deserialize();
 	}
@@ -46,6 +62,10 @@ namespace KuchCraft {
 	{
 		Save();
 
+		/// Chunks can still be filled by worker threads, and the save has to be written before the world is gone
+		ThreadPool::Wait();
+		m_Saver.Wait();
+
 		for (auto handle : m_Registry.view<entt::entity>())
 		{
 			Entity entity = { handle, this };
@@ -55,11 +75,11 @@ namespace KuchCraft {
 			DestroyEntity(entity);
 		}
 
-		for (auto it = m_Chunks.begin(); it != m_Chunks.end();)
-		{
-			delete it->second;
-			it = m_Chunks.erase(it);
-		}
+		m_Chunks.Clear(m_RetiredChunks);
+		for (Chunk* chunk : m_RetiredChunks)
+			m_ChunkPool.Destroy(chunk);
+
+		m_RetiredChunks.clear();
 
 	}
 
@@ -139,29 +159,131 @@ namespace KuchCraft {
 		if (player && player.HasComponent<TransformComponent>())
 			playerTransform = player.GetComponent<TransformComponent>();
 
-		/// Create new chunks within the render distance
-		for (float dx = -(float)config.RenderDistance * chunk_size_XZ; dx <= config.RenderDistance * chunk_size_XZ; dx += chunk_size_XZ)
+		/// Keep chunks within the memory retention range around the player, chunks leaving it are retired.
+		/// Changing the distances at runtime only re-slots loaded chunks, nothing is generated again.
+		/// Chunks one ring past the render distance are generated too, so every visible chunk has all of its neighbors.
+		/// Both areas are discs and are only updated when the player chunk or the distances change,
+		/// and then only the coordinates that entered or left them are visited.
+		glm::ivec2 playerChunk        = ChunkGrid::GetChunkCoord(playerTransform.Translation);
+		int        generationDistance = (int)config.RenderDistance + 1;
+		uint32_t   gridRadius         = std::max(config.RenderDistance + config.KeptInMemoryDistance, (uint32_t)generationDistance);
+
+		if (playerChunk != m_Chunks.GetCenter() || gridRadius != m_Chunks.GetRadius() || generationDistance != m_GenerationDistance)
 		{
-			for (float dz = -(float)config.RenderDistance * chunk_size_XZ; dz <= config.RenderDistance * chunk_size_XZ; dz += chunk_size_XZ)
+			/// The pool holds the whole grid and the retired chunks still used by worker threads
+			uint32_t gridSide = 2 * gridRadius + 1;
+			m_ChunkPool.Reserve(gridSide * gridSide + 2 * std::max(ThreadPool::GetThreadCount(), 1u) * chunk_jobs_per_worker, config.ChunkPoolHugePages);
+
+			/// Saved chunks ahead of the player are prefetched in the background, they are loaded soon
+			if (m_GenerationDistance >= 0 && playerChunk != m_Chunks.GetCenter())
 			{
-				glm::vec3 chunkPosition = Chunk::GetOrigin(playerTransform.Translation + glm::vec3(dx, 0.0f, dz));
-				if (!GetChunk(chunkPosition))
-					m_Chunks[chunkPosition] = new Chunk(this, chunkPosition);
+				glm::vec2 direction = glm::vec2(playerChunk - m_Chunks.GetCenter());
+				ThreadPool::Submit([this, playerChunk, direction, generationDistance]() {
+					m_ChunkStorage.PrefetchAhead(playerChunk, direction, generationDistance);
+				});
 			}
+
+			size_t firstRetired = m_RetiredChunks.size();
+			m_Chunks.Resize(gridRadius, m_RetiredChunks);
+			m_Chunks.SetCenter(playerChunk, m_RetiredChunks);
+			/// Retired chunks are queued right away, a chunk requested again at the same coordinate must load their blocks.
+			/// Chunks still being generated were never built and have nothing to save.
+			for (size_t i = firstRetired; i < m_RetiredChunks.size(); i++)
+			{
+				Chunk* chunk = m_RetiredChunks[i];
+				chunk->SetState(ChunkState::Unloading);
+
+				if (!chunk->IsBuilded() || chunk->IsBuilding() || !chunk->IsModified())
+					continue;
+
+				m_ChunkStorage.QueueSave(chunk->CreateSaveSnapshot(config.ChunkDeltaPersistence));
+				chunk->SetModified(false);
+				m_HasUnwrittenChunks = true;
+			}
+
+			m_LastRetiredChunks   = (uint32_t)(m_RetiredChunks.size() - firstRetired);
+			m_LastRequestedChunks = 0;
+
+			/// After a change of the distance the whole area is visited, chunks that are already loaded are skipped
+			int excludedDistance = generationDistance == m_GenerationDistance ? m_GenerationDistance : -1;
+			ChunkGrid::ForEachInDiscDifference(playerChunk, generationDistance, m_GenerationCenter, excludedDistance, [&](const glm::ivec2& coord) {
+				if (m_Chunks.Get(coord))
+					return;
+
+				m_Chunks.Insert(m_ChunkPool.Create(this, { coord.x * chunk_size_XZ, 0.0f, coord.y * chunk_size_XZ }));
+				m_GenerateQueue.Push(coord, GetChunkPriority(coord));
+				m_LastRequestedChunks++;
+			});
+
+			m_GenerationCenter   = playerChunk;
+			m_GenerationDistance = generationDistance;
+		}
+
+		/// Take chunks finished by worker threads, this work is always done but counts towards the frame budget
+		m_WorkBudget.BeginFrame(Application::GetWindow().GetRawDeltaTime() * 1000.0f, config.ChunkWorkBudgetMs, config.TargetFrameTimeMs);
+
+		m_BuiltChunks.PopAll(m_FinishedChunksBuffer);
+		for (Chunk* chunk : m_FinishedChunksBuffer)
+		{
+			auto start = ChunkWorkBudget::Clock::now();
+
+			chunk->SetBuilding(false);
+			m_ChunksBuilding--;
+
+			if (chunk->GetState() == ChunkState::Unloading)
+				continue;
+
+			chunk->OnBuildFinished();
+
+			/// The new chunk may complete its own neighborhood and the neighborhoods of the chunks around it
+			EnqueueIfMeshable(chunk);
+			for (uint8_t i = 0; i < chunk_neighbor_count; i++)
+				EnqueueIfMeshable(chunk->GetNeighbor((ChunkNeighbor)i));
+
+			m_WorkBudget.Record(ChunkTask::FinishGenerate, start);
 		}
 
-		/// Remove chunks outside the memory retention range
-		float delDist  = (float)(config.RenderDistance + config.KeptInMemoryDistance) * chunk_size_XZ;
-		float delDist2 = delDist * delDist;
-		for (auto it = m_Chunks.begin(); it != m_Chunks.end();)
+		m_MeshedChunks.PopAll(m_FinishedChunksBuffer);
+		for (Chunk* chunk : m_FinishedChunksBuffer)
 		{
-			if (glm::length2(playerTransform.Translation - glm::vec3(it->first)) > delDist2)
+			auto start = ChunkWorkBudget::Clock::now();
+
+			chunk->SetMeshing(false);
+			chunk->OnRecreateFinished();
+			m_ChunksMeshing--;
+
+			/// Retired chunks are not meshed again
+			if (chunk->IsRecreatePending())
 			{
-				delete it->second;
-				it = m_Chunks.erase(it);
+				chunk->SetRecreatePending(false);
+				if (chunk->GetState() != ChunkState::Unloading)
+					RecreateChunk(chunk);
 			}
-			else
-				++it;
+
+			m_WorkBudget.Record(ChunkTask::FinishMesh, start);
+		}
+
+		/// Delete retired chunks, chunks used by worker threads are deleted once they are finished
+		std::erase_if(m_RetiredChunks, [this](Chunk* chunk) {
+			if (chunk->IsBuilding() || chunk->IsMeshing())
+				return false;
+
+			m_ChunkPool.Destroy(chunk);
+			return true;
+		});
+
+		/// Queued chunks are written once the save thread is free, they are loaded from memory until then
+		if (m_HasUnwrittenChunks && m_Saver.IsIdle())
+		{
+			m_Saver.Submit([this]() { return m_ChunkStorage.WritePending(); });
+			m_HasUnwrittenChunks = false;
+		}
+
+		if (config.AutosaveIntervalSeconds > 0 && !m_Path.empty())
+		{
+			m_TimeSinceSave += Application::GetWindow().GetRawDeltaTime();
+			if (m_TimeSinceSave >= (float)config.AutosaveIntervalSeconds && m_Saver.IsIdle())
+				Save();
 		}
 
 		/// Update primary camera and find visible chunks
@@ -175,75 +297,76 @@ namespace KuchCraft {
 				cameraComponent.Camera.SetData(transformComponent.Translation, transformComponent.Rotation);
 
 			ViewFrustum viewFrustom(cameraEntity.GetComponent<CameraComponent>().Camera.GetViewProjection());
-			for (const auto& [pos, chunk] : m_Chunks)
-			{
+			m_Chunks.ForEach([&](Chunk* chunk) {
 				if (!chunk->IsRecreated())
-					continue;
+					return;
 
 				AABB chunkAABB{ chunk->GetPosition(), chunk->GetPosition() + glm::vec3{ chunk_size_XZ, chunk_size_Y, chunk_size_XZ } };
 				if (viewFrustom.IsAABBVisible(chunkAABB))
 					m_VisibleChunks.push_back(chunk);
+			});
+
+			/// Queued work is ordered again once the player enters another chunk or looks elsewhere
+			glm::vec3 forward = cameraComponent.Camera.GetForwardDirection();
+			if (!m_HasPriorityFrustum || glm::dot(forward, m_PriorityForward) < chunk_reprioritize_view_cos || playerChunk != m_PriorityCenter)
+			{
+				if (m_HasPriorityFrustum && playerChunk != m_PriorityCenter)
+					m_MoveDirection = glm::normalize(glm::vec2(playerChunk - m_PriorityCenter));
+
+				m_PriorityCenter     = playerChunk;
+				m_PriorityForward    = forward;
+				m_PriorityFrustum    = viewFrustom;
+				m_HasPriorityFrustum = true;
+
+				auto priority = [this](const glm::ivec2& coord) { return GetChunkPriority(coord); };
+				m_GenerateQueue.Reprioritize(priority);
+				m_MeshQueue    .Reprioritize(priority);
 			}
 		}
 		
-		/// Build and refresh chunks with a limited number per frame
-		uint32_t chunksToBuild    = config.ChunksToBuildInFrame;
-		uint32_t chunksToRecreate = config.ChuksToRecreateInFrame;
-		for (const auto& [pos, chunk] : m_Chunks)
+		/// Build and mesh queued chunks while the frame budget allows it.
+		/// Building and meshing is done by worker threads, the number of scheduled jobs is kept small
+		/// so chunks left behind by a moving player do not clog the queue.
+		/// Queues hold coordinates, entries of chunks that were retired or already handled are dropped.
+		uint32_t maxChunkJobs = std::max(ThreadPool::GetThreadCount(), 1u) * chunk_jobs_per_worker;
+
+		while (!m_GenerateQueue.IsEmpty() && m_ChunksBuilding < maxChunkJobs && m_WorkBudget.CanAfford(ChunkTask::Generate))
 		{
-			/// Build new chunks if they are not yet ready
-			if (!chunk->IsBuilded() && chunksToBuild > 0)
-			{
+			Chunk* chunk = m_Chunks.Get(m_GenerateQueue.Pop());
+
+			if (!chunk || chunk->GetState() != ChunkState::Requested || chunk->IsBuilding())
+				continue;
+
+			auto start = ChunkWorkBudget::Clock::now();
+
+			chunk->SetBuilding(true);
+			m_ChunksBuilding++;
+
+			ThreadPool::Submit([this, chunk]() {
 				chunk->Build();
-				chunksToBuild--;
-			}
+				m_BuiltChunks.Push(chunk);
+			});
 
-			/// Recreate chunks mesh if they require updating
-			if (!chunk->IsRecreated() && chunksToRecreate > 0)
-			{
-				chunk->Recreate();
-				chunksToRecreate--;
-			}
+			m_WorkBudget.Record(ChunkTask::Generate, start);
+		}
 
-			/// Check if the chunk had missing neighbors, if so - recreate
-			bool hadMissingNeighbors = chunk->GetMissingNeighborsStatus();
-			if (hadMissingNeighbors)
-			{
-				Chunk* leftChunk   = chunk->GetLeftNeighbor();
-				Chunk* rightChunk  = chunk->GetRightNeighbor();
-				Chunk* frontChunk  = chunk->GetFrontNeighbor();
-				Chunk* behindChunk = chunk->GetBehindNeighbor();
-
-				bool currentLeft   = (leftChunk   && leftChunk  ->IsBuilded());
-				bool currentRight  = (rightChunk  && rightChunk ->IsBuilded());
-				bool currentFront  = (frontChunk  && frontChunk ->IsBuilded());
-				bool currentBehind = (behindChunk && behindChunk->IsBuilded());
-
-				bool prevLeft   = chunk->GetLastLeftBuilt();
-				bool prevRight  = chunk->GetLastRightBuilt();
-				bool prevFront  = chunk->GetLastFrontBuilt();
-				bool prevBehind = chunk->GetLastBehindBuilt();
-
-				bool hasMissingNeighbors = !currentLeft || !currentRight || !currentFront || !currentBehind;
-
-				if ((currentLeft  && !prevLeft)  || (currentRight  && !prevRight) ||
-					(currentFront && !prevFront) || (currentBehind && !prevBehind) ||
-					(hadMissingNeighbors && !hasMissingNeighbors))
-				{
-					chunk->Recreate();
-					chunksToRecreate--;
-				}
+		while (!m_MeshQueue.IsEmpty() && m_ChunksMeshing < maxChunkJobs && m_WorkBudget.CanAfford(ChunkTask::Mesh))
+		{
+			Chunk* chunk = m_Chunks.Get(m_MeshQueue.Pop());
 
-				chunk->SetLastLeftBuilt(currentLeft);
-				chunk->SetLastRightBuilt(currentRight);
-				chunk->SetLastFrontBuilt(currentFront);
-				chunk->SetLastBehindBuilt(currentBehind);
+			if (!chunk || chunk->GetState() != ChunkState::Meshable || chunk->IsMeshing())
+				continue;
 
-				chunk->SetMissingNeighborsStatus(hasMissingNeighbors);
+			/// A neighbor may have left the grid while the chunk was queued, it is queued again once the neighbor is back
+			if (!chunk->IsNeighborhoodGenerated())
+			{
+				chunk->SetState(ChunkState::Generated);
+				continue;
 			}
-			
-			/// Update the chunk
-			chunk->OnUpdate(dt);	
+
+			auto start = ChunkWorkBudget::Clock::now();
+			RecreateChunk(chunk);
+			m_WorkBudget.Record(ChunkTask::Mesh, start);
 		}
 
 		/// Update native scripts for each entity
@@ -259,6 +382,57 @@ namespace KuchCraft {
 		});
 	}
 
+	bool World::RecreateChunk(Chunk* chunk)
+	{
+		if (chunk->IsMeshing())
+		{
+			chunk->SetRecreatePending(true);
+			return false;
+		}
+
+		auto snapshot = chunk->CreateMeshSnapshot();
+		if (!snapshot)
+			return false;
+
+		chunk->SetMeshing(true);
+		m_ChunksMeshing++;
+
+		ThreadPool::Submit([this, chunk, snapshot]() {
+			chunk->Recreate(*snapshot);
+			m_MeshedChunks.Push(chunk);
+		});
+
+		return true;
+	}
+
+	void World::EnqueueIfMeshable(Chunk* chunk)
+	{
+		if (!chunk || chunk->GetState() != ChunkState::Generated || !chunk->IsNeighborhoodGenerated())
+			return;
+
+		chunk->SetState(ChunkState::Meshable);
+		m_MeshQueue.Push(chunk->GetCoord(), GetChunkPriority(chunk->GetCoord()));
+	}
+
+	float World::GetChunkPriority(const glm::ivec2& coord) const
+	{
+		glm::vec2 offset   = glm::vec2(coord - m_PriorityCenter);
+		float     priority = glm::length(offset);
+
+		if (priority > 0.0f)
+			priority *= 1.0f - chunk_movement_priority_weight * glm::dot(offset / priority, m_MoveDirection);
+
+		if (m_HasPriorityFrustum)
+		{
+			glm::vec3 position = { coord.x * chunk_size_XZ, 0.0f, coord.y * chunk_size_XZ };
+			AABB chunkAABB{ position, position + glm::vec3{ chunk_size_XZ, chunk_size_Y, chunk_size_XZ } };
+			if (!m_PriorityFrustum.IsAABBVisible(chunkAABB))
+				priority += chunk_offscreen_priority_penalty;
+		}
+
+		return priority;
+	}
+
 	void World::Render()
 	{
 		Camera* mainCamera = GetPrimaryCamera();
@@ -385,6 +559,154 @@ namespace KuchCraft {
 #endif
 	}
 
+#ifdef  INCLUDE_IMGUI
+	/// Results of comparing palette compressed chunk storage with a dense array
+	struct ChunkStorageBenchmark
+	{
+		bool   Done = false;
+		size_t PalettedBytes = 0;
+		size_t DenseBytes = 0;
+		uint32_t AllocatedSections = 0;
+		double PalettedSequentialNs = 0.0;
+		double DenseSequentialNs    = 0.0;
+		double PalettedRandomNs     = 0.0;
+		double DenseRandomNs        = 0.0;
+	};
+
+	/// Measures average time of a single block read from the chunk storage and from its dense copy
+	static ChunkStorageBenchmark RunChunkStorageBenchmark(const Chunk* chunk)
+	{
+		constexpr uint32_t sequential_passes = 64;
+		constexpr uint32_t random_reads      = 1 << 22;
+
+		/// Dense copy uses the original [x][y][z] layout
+		auto denseIndex = [](const glm::ivec3& position) {
+			return (position.x * chunk_size_Y + position.y) * chunk_size_XZ + position.z;
+		};
+
+		std::vector<Item> dense(chunk_block_count);
+		for (int x = 0; x < chunk_size_XZ; x++)
+			for (int y = 0; y < chunk_size_Y; y++)
+				for (int z = 0; z < chunk_size_XZ; z++)
+					dense[denseIndex({ x, y, z })] = chunk->Get({ x, y, z });
+
+		std::mt19937 engine(1234);
+		std::vector<glm::ivec3> positions(random_reads);
+		for (auto& position : positions)
+			position = { (int)(engine() % chunk_size_XZ), (int)(engine() % chunk_size_Y), (int)(engine() % chunk_size_XZ) };
+
+		auto measure = [](auto&& function, uint32_t reads) {
+			auto start = std::chrono::high_resolution_clock::now();
+			volatile uint32_t sink = function();
+			auto end = std::chrono::high_resolution_clock::now();
+			(void)sink;
+			return std::chrono::duration<double, std::nano>(end - start).count() / reads;
+		};
+
+		ChunkStorageBenchmark result;
+		result.Done          = true;
+		result.PalettedBytes = chunk->GetBlocksMemoryUsage();
+		result.DenseBytes    = chunk_block_count * sizeof(Item);
+		for (int i = 0; i < chunk_section_count; i++)
+			result.AllocatedSections += chunk->GetSection(i) ? 1 : 0;
+
+		result.PalettedSequentialNs = measure([&]() {
+			uint32_t sum = 0;
+			for (uint32_t pass = 0; pass < sequential_passes; pass++)
+				for (int x = 0; x < chunk_size_XZ; x++)
+					for (int y = 0; y < chunk_size_Y; y++)
+						for (int z = 0; z < chunk_size_XZ; z++)
+							sum += chunk->Get({ x, y, z }).GetID();
+			return sum;
+		}, sequential_passes * chunk_block_count);
+
+		result.DenseSequentialNs = measure([&]() {
+			uint32_t sum = 0;
+			for (uint32_t pass = 0; pass < sequential_passes; pass++)
+				for (int x = 0; x < chunk_size_XZ; x++)
+					for (int y = 0; y < chunk_size_Y; y++)
+						for (int z = 0; z < chunk_size_XZ; z++)
+							sum += dense[denseIndex({ x, y, z })].GetID();
+			return sum;
+		}, sequential_passes * chunk_block_count);
+
+		result.PalettedRandomNs = measure([&]() {
+			uint32_t sum = 0;
+			for (const auto& position : positions)
+				sum += chunk->Get(position).GetID();
+			return sum;
+		}, random_reads);
+
+		result.DenseRandomNs = measure([&]() {
+			uint32_t sum = 0;
+			for (const auto& position : positions)
+				sum += dense[denseIndex(position)].GetID();
+			return sum;
+		}, random_reads);
+
+		return result;
+	}
+
+	/// Results of comparing the greedy mesher with the one quad per face mesher
+	struct ChunkMeshingBenchmark
+	{
+		bool   Done = false;
+		uint32_t Quads       = 0;
+		uint32_t GreedyQuads = 0;
+		double   MeshMs       = 0.0;
+		double   GreedyMeshMs = 0.0;
+		double   CullingMs          = 0.0;
+		double   ReferenceCullingMs = 0.0;
+		bool     CullingMatches     = false;
+	};
+
+	/// Measures average time of building the mesh of a chunk with both meshers
+	static ChunkMeshingBenchmark RunChunkMeshingBenchmark(const Chunk* chunk)
+	{
+		constexpr uint32_t runs = 32;
+
+		auto snapshot = chunk->CreateMeshSnapshot();
+		if (!snapshot)
+			return {};
+
+		auto measureCulling = [&](auto&& culling, ChunkFaceMasks& masks) {
+			auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < runs; i++)
+				culling(*snapshot, masks);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+		};
+
+		auto measure = [&](auto&& mesher, uint32_t& quads) {
+			std::vector<uint32_t> output;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < runs; i++)
+			{
+				output.clear();
+				mesher(*snapshot, output);
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+
+			quads = (uint32_t)output.size() / (quad_vertex_count * 2);
+			return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+		};
+
+		ChunkMeshingBenchmark result;
+		result.Done         = true;
+		result.MeshMs       = measure(ChunkRenderData::BuildMesh,       result.Quads);
+		result.GreedyMeshMs = measure(ChunkRenderData::BuildGreedyMesh, result.GreedyQuads);
+
+		auto masks          = std::make_unique<ChunkFaceMasks>();
+		auto referenceMasks = std::make_unique<ChunkFaceMasks>();
+		result.CullingMs          = measureCulling(ChunkRenderData::FindVisibleFaces,          *masks);
+		result.ReferenceCullingMs = measureCulling(ChunkRenderData::FindVisibleFacesReference, *referenceMasks);
+		result.CullingMatches     = std::memcmp(masks.get(), referenceMasks.get(), sizeof(ChunkFaceMasks)) == 0;
+
+		return result;
+	}
+#endif
+
 	void World::OnImGuiRender()
 	{
 #ifdef  INCLUDE_IMGUI
@@ -399,6 +721,132 @@ namespace KuchCraft {
 
 			if (ImGui::DragInt("Render distance", &rdr, 1, 20))
 				ApplicationConfig::GetWorldData().RenderDistance = rdr;
+
+			ImGui::Text("Loaded chunks: %u (grid capacity: %u, retired: %u)", m_Chunks.GetCount(), m_Chunks.GetCapacity(), (uint32_t)m_RetiredChunks.size());
+			ImGui::Text("Chunks building: %u, meshing: %u (worker threads: %u)", m_ChunksBuilding, m_ChunksMeshing, ThreadPool::GetThreadCount());
+			ImGui::Text("Chunks queued for building: %u, meshing: %u", m_GenerateQueue.GetSize(), m_MeshQueue.GetSize());
+			m_ChunkPool.RenderImGui();
+			ImGui::Text("Last area update: %u chunks requested, %u retired", m_LastRequestedChunks, m_LastRetiredChunks);
+
+			ImGui::DragFloat("Chunk work budget (ms)", &ApplicationConfig::GetWorldData().ChunkWorkBudgetMs, 0.05f, 0.25f, 50.0f);
+			ImGui::DragFloat("Target frame time (ms)", &ApplicationConfig::GetWorldData().TargetFrameTimeMs, 0.1f, 1.0f, 100.0f);
+			m_WorkBudget.RenderImGui();
+		}
+
+		if (ImGui::CollapsingHeader("World generator"))
+			WorldGenerator::OnImGuiRender();
+
+		if (ImGui::CollapsingHeader("Chunk storage"))
+		{
+			constexpr float mega_byte = 1024.0f * 1024.0f;
+
+			size_t   palettedBytes = 0;
+			uint32_t emptySections = 0;
+			std::map<uint32_t, uint32_t> sectionsPerBits;
+			m_Chunks.ForEach([&](const Chunk* chunk) {
+				palettedBytes += chunk->GetBlocksMemoryUsage();
+				for (int i = 0; i < chunk_section_count; i++)
+				{
+					if (const PalettedContainer* section = chunk->GetSection(i))
+						sectionsPerBits[section->GetBitsPerEntry()]++;
+					else
+						emptySections++;
+				}
+			});
+
+			size_t denseBytes = (size_t)m_Chunks.GetCount() * chunk_block_count * sizeof(Item);
+			ImGui::Text("Block memory: %.2f MB (dense: %.2f MB)", palettedBytes / mega_byte, denseBytes / mega_byte);
+			ImGui::Text("Empty sections: %u", emptySections);
+			for (const auto& [bits, count] : sectionsPerBits)
+				ImGui::Text("%2u bits per block: %u sections", bits, count);
+
+			ImGui::Checkbox("Save chunk edits only", &ApplicationConfig::GetWorldData().ChunkDeltaPersistence);
+			m_ChunkStorage.RenderImGui();
+
+			ImGui::Text("Last save snapshot on the main thread: %.3f ms", m_LastSaveSnapshotMs);
+			m_Saver.RenderImGui();
+
+			static ChunkStorageReadBenchmark readBenchmark;
+			if (ImGui::Button("Run region read benchmark", ImVec2(ImGui::GetContentRegionAvail().x, 0.0f)))
+			{
+				/// Fly-through starting at the player towards the camera direction over already saved chunks
+				constexpr int flight_distance = 64;
+
+				TransformComponent playerTransform({ 0.0f, 0.0f, 0.0f });
+				if (auto player = GetPlayer(); player && player.HasComponent<TransformComponent>())
+					playerTransform = player.GetComponent<TransformComponent>();
+
+				glm::vec2 direction = { 1.0f, 0.0f };
+				if (Camera* camera = GetPrimaryCamera())
+				{
+					glm::vec3 forward = camera->GetForwardDirection();
+					if (glm::length(glm::vec2(forward.x, forward.z)) > 0.01f)
+						direction = { forward.x, forward.z };
+				}
+
+				readBenchmark = m_ChunkStorage.RunReadBenchmark(ChunkGrid::GetChunkCoord(playerTransform.Translation), direction,
+					(int)ApplicationConfig::GetWorldData().RenderDistance + 1, flight_distance);
+			}
+
+			if (readBenchmark.Done)
+			{
+				ImGui::Text("Fly-through: %u saved chunks, %.2f MB", readBenchmark.Chunks, readBenchmark.Bytes / mega_byte);
+				ImGui::Text("Mapped reads:   %.2f ms", readBenchmark.MappedMs);
+				ImGui::Text("Buffered reads: %.2f ms", readBenchmark.BufferedMs);
+			}
+
+			static ChunkStorageBenchmark benchmark;
+			if (ImGui::Button("Run access benchmark", ImVec2(ImGui::GetContentRegionAvail().x, 0.0f)))
+			{
+				/// Benchmark the chunk under the player, it is the most representative one
+				TransformComponent playerTransform({ 0.0f, 0.0f, 0.0f });
+				if (auto player = GetPlayer(); player && player.HasComponent<TransformComponent>())
+					playerTransform = player.GetComponent<TransformComponent>();
+
+				Chunk* chunk = GetChunk(playerTransform.Translation);
+				if (chunk && chunk->IsBuilded())
+					benchmark = RunChunkStorageBenchmark(chunk);
+			}
+
+			if (benchmark.Done)
+			{
+				ImGui::Text("Chunk memory: %zu B (%u sections), dense: %zu B", benchmark.PalettedBytes, benchmark.AllocatedSections, benchmark.DenseBytes);
+				ImGui::Text("Sequential read: %.3f ns paletted, %.3f ns dense", benchmark.PalettedSequentialNs, benchmark.DenseSequentialNs);
+				ImGui::Text("Random read:     %.3f ns paletted, %.3f ns dense", benchmark.PalettedRandomNs,     benchmark.DenseRandomNs);
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Chunk meshing"))
+		{
+			/// Switching the mesher rebuilds every loaded mesh so the difference is visible right away
+			if (ImGui::Checkbox("Greedy meshing", &ApplicationConfig::GetWorldData().GreedyMeshing))
+			{
+				m_Chunks.ForEach([&](Chunk* chunk) {
+					if (chunk->IsRecreated())
+						RecreateChunk(chunk);
+				});
+			}
+
+			static ChunkMeshingBenchmark benchmark;
+			if (ImGui::Button("Run meshing benchmark", ImVec2(ImGui::GetContentRegionAvail().x, 0.0f)))
+			{
+				TransformComponent playerTransform({ 0.0f, 0.0f, 0.0f });
+				if (auto player = GetPlayer(); player && player.HasComponent<TransformComponent>())
+					playerTransform = player.GetComponent<TransformComponent>();
+
+				Chunk* chunk = GetChunk(playerTransform.Translation);
+				if (chunk && chunk->IsBuilded())
+					benchmark = RunChunkMeshingBenchmark(chunk);
+			}
+
+			if (benchmark.Done)
+			{
+				ImGui::Text("Per face: %6u quads (%7u vertices), %.3f ms", benchmark.Quads,       benchmark.Quads       * quad_vertex_count, benchmark.MeshMs);
+				ImGui::Text("Greedy:   %6u quads (%7u vertices), %.3f ms", benchmark.GreedyQuads, benchmark.GreedyQuads * quad_vertex_count, benchmark.GreedyMeshMs);
+				ImGui::Text("Face culling: %.3f ms bit masks, %.3f ms per block lookups (x%.1f)", benchmark.CullingMs, benchmark.ReferenceCullingMs,
+					benchmark.CullingMs > 0.0 ? benchmark.ReferenceCullingMs / benchmark.CullingMs : 0.0);
+				ImGui::Text("Culling results match: %s", benchmark.CullingMatches ? "yes" : "no");
+			}
 		}
 
 		if (ImGui::CollapsingHeader("Time control"))
@@ -872,8 +1320,38 @@ namespace KuchCraft {
 
 	bool World::Save()
 	{
+		auto start = std::chrono::steady_clock::now();
+		m_TimeSinceSave = 0.0f;
+
+		/// Chunks being meshed are only read by worker threads, so they can be saved too
+		bool saveEdits = ApplicationConfig::GetWorldData().ChunkDeltaPersistence;
+		auto queueChunk = [&](Chunk* chunk) {
+			if (!chunk->IsBuilded() || chunk->IsBuilding() || !chunk->IsModified())
+				return;
+
+			/// The snapshot stays queued until it is written, so the chunk counts as saved right away
+			m_ChunkStorage.QueueSave(chunk->CreateSaveSnapshot(saveEdits));
+			chunk->SetModified(false);
+		};
+
+		/// Retired chunks were queued when they left the grid
+		m_Chunks.ForEach(queueChunk);
+
 		WorldSerializer serializer(this);
-		return serializer.Serialize();
+		auto writeWorldData = serializer.CreateSaveTask();
+
+		m_LastSaveSnapshotMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (!writeWorldData)
+			return false;
+
+		m_HasUnwrittenChunks = false;
+		m_Saver.Submit([this, writeWorldData = std::move(writeWorldData)]() {
+			bool chunksWritten = m_ChunkStorage.WritePending();
+			return writeWorldData() && chunksWritten;
+		});
+
+		return true;
 	}
 
 	Entity World::CreateEntity(const std::string& name)
@@ -984,11 +1462,7 @@ namespace KuchCraft {
 
 	Chunk* World::GetChunk(const glm::vec3& position)
 	{
-		auto it = m_Chunks.find(Chunk::GetOrigin(position));
-		if (it != m_Chunks.end())
-			return it->second;
-
-		return nullptr;
+		return m_Chunks.Get(ChunkGrid::GetChunkCoord(position));
 	}
 
 
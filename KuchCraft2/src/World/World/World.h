@@ -10,11 +10,20 @@
 
 #include "Core/UUID.h"
 #include "Core/Event.h"
+#include "Core/ConcurrentQueue.h"
 
 #include "Graphics/Data/Camera.h"
 
+#include "Physics/ViewFrustum.h"
+
 #include "World/Chunk/Chunk.h"
+#include "World/Chunk/ChunkGrid.h"
+#include "World/Chunk/ChunkPool.h"
+#include "World/Chunk/ChunkStorage.h"
+#include "World/Chunk/ChunkWorkQueue.h"
+#include "World/World/ChunkWorkBudget.h"
 #include "World/World/InGameTime.h"
+#include "World/World/WorldSaver.h"
 
 namespace std {
 	template <>
@@ -68,7 +77,8 @@ namespace KuchCraft {
 		/// This method handles the application's custom ImGui rendering logic.
 		void OnImGuiRender();
 
-		/// Saves world data to files
+		/// Takes snapshots of world data and every modified built chunk and writes them to files in the background
+		/// @return True if the save was queued.
 		bool Save();
 
 		/// Creates a new entity with an optional name.
@@ -142,6 +152,11 @@ namespace KuchCraft {
 		/// @return A pointer to the chunk containing the position, or nullptr if not found.
 		Chunk* GetChunk(const glm::vec3& position);
 
+		/// Retrieves a chunk based on its chunk coordinate.
+		/// @param coord - the chunk coordinate (world position divided by chunk_size_XZ).
+		/// @return A pointer to the chunk, or nullptr if not loaded.
+		inline Chunk* GetChunk(const glm::ivec2& coord) const { return m_Chunks.Get(coord); }
+
 		/// Checks if the world is currently paused.
 	    /// @return True if the world is paused; false otherwise.
 		inline [[nodiscard]] bool IsPaused() const { return m_IsPaused; }
@@ -150,6 +165,9 @@ namespace KuchCraft {
 		/// @param status - true to pause the world, false to resume it.
 		void Pause(bool status) { m_IsPaused = status; }
 
+		/// Retrieves the region files chunks are saved to and loaded from.
+		inline [[nodiscard]] ChunkStorage& GetChunkStorage() { return m_ChunkStorage; }
+
 		/// Retrieves world saving path
 		/// @return Save path
 		inline [[nodiscard]] const std::filesystem::path& GetPath() const { return m_Path; }
@@ -167,6 +185,23 @@ namespace KuchCraft {
 		/// @return Returns true if the event has been handled and should stop being propagated further
 		[[nodiscard]] bool OnWindowResize(WindowResizeEvent& e);
 
+		/// Schedules rebuilding of the chunk mesh on a worker thread.
+		/// If the chunk is already being meshed, the rebuild is repeated once the running one finishes.
+		/// @param chunk - the chunk to remesh.
+		/// @return True if meshing was scheduled now, false otherwise.
+		bool RecreateChunk(Chunk* chunk);
+
+		/// Queues a generated chunk for meshing once all of its neighbors are generated.
+		/// @param chunk - the chunk to check, may be nullptr.
+		void EnqueueIfMeshable(Chunk* chunk);
+
+		/// Calculates the order in which queued chunk work is done, lower values first.
+		/// Grows with the distance to the player, chunks ahead of the movement come earlier
+		/// and chunks outside the view frustum later.
+		/// @param coord - the chunk coordinate.
+		/// @return The priority value.
+		float GetChunkPriority(const glm::ivec2& coord) const;
+
 	private:
 		/// The registry managing all entities and their components.
 		entt::registry m_Registry;
@@ -183,12 +218,76 @@ namespace KuchCraft {
 		/// Maps UUIDs to entity handles for quick lookup.
 		std::unordered_map<UUID, entt::entity> m_EntityMap;
 
-		/// Stores all the chunks in the world, indexed by their integer coordinates.
-		std::unordered_map<glm::ivec3, Chunk*> m_Chunks;
+		/// Region files built chunks are saved to when they leave the grid or the world is saved
+		ChunkStorage m_ChunkStorage;
+
+		/// Writes saves in the background, declared after the storage so its tasks finish before the storage is gone
+		WorldSaver m_Saver;
+
+		/// Whether retired chunks were queued for saving since the save thread was last given work
+		bool m_HasUnwrittenChunks = false;
+
+		/// Time since the last save in seconds, drives autosaving
+		float m_TimeSinceSave = 0.0f;
+
+		/// Main thread time the last save took to take its snapshots, in milliseconds
+		float m_LastSaveSnapshotMs = 0.0f;
+
+		/// Storage of every chunk of the world, declared before the chunk containers so it outlives them.
+		ChunkPool m_ChunkPool;
+
+		/// Stores loaded chunks in a window around the player, indexed by their chunk coordinates.
+		ChunkGrid m_Chunks;
+
+		/// Chunks removed from the grid, deleted once worker threads are done with them
+		std::vector<Chunk*> m_RetiredChunks;
+
+		/// Coordinates of requested chunks waiting to be generated
+		ChunkWorkQueue m_GenerateQueue;
+
+		/// Coordinates of chunks with a complete neighborhood waiting to be meshed
+		ChunkWorkQueue m_MeshQueue;
+
+		/// Limits the main thread time spent on chunk work in a frame
+		ChunkWorkBudget m_WorkBudget;
+
+		/// Player chunk the queued priorities were computed for
+		glm::ivec2 m_PriorityCenter = { 0, 0 };
+
+		/// Direction in which the player last crossed a chunk border
+		glm::vec2 m_MoveDirection = { 0.0f, 0.0f };
+
+		/// Camera direction and frustum the queued priorities were computed for
+		glm::vec3   m_PriorityForward = { 0.0f, 0.0f, 0.0f };
+		ViewFrustum m_PriorityFrustum;
+		bool        m_HasPriorityFrustum = false;
+
+		/// Disc around the player chunk in which chunks were last requested, negative distance if none were requested
+		glm::ivec2 m_GenerationCenter   = { 0, 0 };
+		int        m_GenerationDistance = -1;
+
+		/// Number of chunks requested and retired by the last change of the player chunk
+		uint32_t m_LastRequestedChunks = 0;
+		uint32_t m_LastRetiredChunks   = 0;
 
 		/// Every frame updated storege of visible by player chunks
 		std::vector<Chunk*> m_VisibleChunks;
 
+		/// Chunks filled with blocks by worker threads, waiting to be handed back to the main thread
+		ConcurrentQueue<Chunk*> m_BuiltChunks;
+
+		/// Chunks meshed by worker threads, waiting for their mesh to be published on the main thread
+		ConcurrentQueue<Chunk*> m_MeshedChunks;
+
+		/// Reused storage for chunks taken from m_BuiltChunks and m_MeshedChunks
+		std::vector<Chunk*> m_FinishedChunksBuffer;
+
+		/// Number of chunks currently built on worker threads
+		uint32_t m_ChunksBuilding = 0;
+
+		/// Number of chunks currently meshed on worker threads
+		uint32_t m_ChunksMeshing = 0;
+
 		/// Indicates whether the world is currently paused.
 		bool m_IsPaused = false;
 
@@ -0,0 +1,106 @@
+///
+/// @file WorldSaver.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/World/WorldSaver.h"
+
+#ifdef  INCLUDE_IMGUI
+	#include <imgui.h>
+#endif
+
+namespace KuchCraft {
+
+	WorldSaver::~WorldSaver()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Running = false;
+		}
+		m_TaskAvailable.notify_all();
+
+		/// Queued tasks are finished before the thread exits
+		if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	void WorldSaver::Submit(std::function<bool()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_Thread.joinable())
+			{
+				m_Running = true;
+				m_Thread  = std::thread(&WorldSaver::SaveLoop, this);
+			}
+
+			m_Tasks.push(std::move(task));
+			m_PendingTasks++;
+		}
+		m_TaskAvailable.notify_one();
+	}
+
+	void WorldSaver::Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_AllTasksFinished.wait(lock, [this]() { return m_PendingTasks == 0; });
+	}
+
+	bool WorldSaver::IsIdle() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_PendingTasks == 0;
+	}
+
+	void WorldSaver::SaveLoop()
+	{
+		while (true)
+		{
+			std::function<bool()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_TaskAvailable.wait(lock, [this]() { return !m_Tasks.empty() || !m_Running; });
+
+				if (m_Tasks.empty())
+					return;
+
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop();
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			if (!task())
+			{
+				Log::Error("[World Saver] : Save was not fully written");
+				m_FailedTasks++;
+			}
+
+			m_LastTaskMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			m_FinishedTasks++;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_PendingTasks--;
+				if (m_PendingTasks == 0)
+					m_AllTasksFinished.notify_all();
+			}
+		}
+	}
+
+	void WorldSaver::RenderImGui() const
+	{
+#ifdef  INCLUDE_IMGUI
+		uint32_t pending = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			pending = m_PendingTasks;
+		}
+
+		ImGui::Text("Background saves: %llu (%llu failed), pending: %u", (uint64_t)m_FinishedTasks, (uint64_t)m_FailedTasks, pending);
+		ImGui::Text("Last background save: %.2f ms", (float)m_LastTaskMs);
+#endif
+	}
+
+}
@@ -0,0 +1,78 @@
+///
+/// @file WorldSaver.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the WorldSaver class, which runs world saves
+///        on a dedicated background thread.
+///
+/// @details The main thread takes snapshots of everything a save needs and submits a task writing them,
+///          so encoding and disk writes never stall a frame. Tasks run one at a time in submission order,
+///          a later save never overtakes an earlier one. The thread is started with the first task.
+///
+/// @thread_safety Thread-safe, tasks are usually submitted by the main thread. Wait() must not be called from inside a task.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class WorldSaver
+	{
+	public:
+		WorldSaver() = default;
+
+		/// Finishes all submitted tasks and joins the save thread.
+		~WorldSaver();
+
+		WorldSaver(const WorldSaver&) = delete;
+		WorldSaver& operator=(const WorldSaver&) = delete;
+
+		/// Queues a task to be executed on the save thread.
+		/// @param task - the task to execute, returning whether everything was written.
+		void Submit(std::function<bool()> task);
+
+		/// Blocks until every submitted task has finished.
+		void Wait();
+
+		/// Checks if no task is queued or running.
+		[[nodiscard]] bool IsIdle() const;
+
+		/// Renders the save stats.
+		void RenderImGui() const;
+
+	private:
+		/// Main loop of the save thread.
+		void SaveLoop();
+
+	private:
+		std::thread m_Thread;
+
+		/// Tasks waiting for the save thread.
+		std::queue<std::function<bool()>> m_Tasks;
+
+		/// Protects the task queue and counters.
+		mutable std::mutex m_Mutex;
+
+		/// Signaled when a task is queued or the saver is shutting down.
+		std::condition_variable m_TaskAvailable;
+
+		/// Signaled when the saver runs out of work.
+		std::condition_variable m_AllTasksFinished;
+
+		/// Number of tasks that are queued or running.
+		uint32_t m_PendingTasks = 0;
+
+		/// Whether the save thread should keep waiting for new tasks.
+		bool m_Running = false;
+
+		/// Number of finished tasks and of tasks that failed to write something.
+		std::atomic<uint64_t> m_FinishedTasks = 0;
+		std::atomic<uint64_t> m_FailedTasks   = 0;
+
+		/// Time the last task took in milliseconds.
+		std::atomic<float> m_LastTaskMs = 0.0f;
+
+	};
+
+}
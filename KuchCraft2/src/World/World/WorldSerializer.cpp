@@ -5,6 +5,7 @@
 #include "World/NativeScripts.h"
 #include "Graphics/TextureManager.h"
 #include "Core/Config.h"
+#include "Core/FileSystem.h"
 
 #include <json.hpp>
 
@@ -73,17 +74,23 @@ namespace KuchCraft {
 	}
 
 	bool WorldSerializer::Serialize()
+	{
+		auto task = CreateSaveTask();
+		return task && task();
+	}
+
+	std::function<bool()> WorldSerializer::CreateSaveTask()
 	{
 		if (!m_World)
 		{
 			Log::Error("[World Serializer] : Invalid World");
-			return false;
+			return nullptr;
 		}
 
 		if (m_World->GetPath().empty())
 		{
 			Log::Error("[World Serializer] : Invalid path");
-			return false;
+			return nullptr;
 		}
 
 		nlohmann::json wjson;
@@ -182,18 +189,27 @@ namespace KuchCraft {
 			wjson["Entities"].push_back(ejson);
 		}
 
-		std::ofstream file(m_World->GetPath() / ApplicationConfig::GetWorldData().WorldDataFile);
-		if (!file.is_open())
-		{
-			Log::Error("[World Serializer] : Failed to open : {}" , m_World->GetPath().string());
-			return false;
-		}
+		/// The tree is a copy of the world state, it is converted to text and written by the task
+		std::filesystem::path path = m_World->GetPath() / ApplicationConfig::GetWorldData().WorldDataFile;
+		return [path, wjson = std::move(wjson)]() {
+			std::string text;
+			try
+			{
+				text = wjson.dump(4, ' ', false, nlohmann::json::error_handler_t::strict);
+			}
+			catch (const std::exception& e)
+			{
+				Log::Error("[World Serializer] : Failed to serialize : {}", e.what());
+				return false;
+			}
 
-		file << wjson.dump(4, ' ', false, nlohmann::json::error_handler_t::strict);
-		file.close();
+			/// A crash during the write leaves the previous world data intact
+			if (!FileSystem::WriteAtomic(path, text.data(), text.size()))
+				return false;
 
-		Log::Info("[World Serializer] : Serialized : {}", m_World->GetPath().string());
-		return true;
+			Log::Info("[World Serializer] : Serialized : {}", path.string());
+			return true;
+		};
 	}
 
 	bool WorldSerializer::SerializeRuntime()
@@ -20,6 +20,12 @@ namespace KuchCraft {
 	    /// @return True if the serialization succeeds, false otherwise.
 		bool Serialize();
 
+		/// Captures the current state of the World and returns a task writing it to the file.
+		/// Must be called on the main thread, as scripts serialize their state here. The task can run
+		/// on any thread, even after the World is gone, and replaces the file atomically.
+		/// @return The task returning true if the file was written, nullptr if the World cannot be saved.
+		std::function<bool()> CreateSaveTask();
+
 		/// Serializes the runtime state of the World.
 	    /// Not implemented yet, reserved for runtime-specific serialization.
 	    /// @return False by default.
@@ -0,0 +1,259 @@
+///
+/// @file NoiseTransform.cpp
+///
+/// @author Michal Kuchnicki
+///
+
+#include "kcpch.h"
+#include "World/WorldGenerator/NoiseTransform.h"
+
+#include <FastNoiseSIMD.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define KC_NOISE_TRANSFORM_X86
+	#include <immintrin.h>
+#endif
+
+/// MSVC allows AVX2 intrinsics in any function, GCC and Clang need them enabled per function
+#if defined(KC_NOISE_TRANSFORM_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define KC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define KC_TARGET_AVX2
+#endif
+
+namespace KuchCraft {
+
+	/// Coefficients of log2(m) = t * (c1 + c3 t^2 + c5 t^4 + c7 t^6 + c9 t^8), t = (m - 1) / (m + 1), ck = 2 / (k ln 2)
+	constexpr float log2_c1 = 2.88539008f;
+	constexpr float log2_c3 = 0.961796694f;
+	constexpr float log2_c5 = 0.577078017f;
+	constexpr float log2_c7 = 0.412198583f;
+	constexpr float log2_c9 = 0.320598898f;
+
+	/// Coefficients of e^g Taylor series used for 2^f, f in [-0.5, 0.5]
+	constexpr float exp_c6 = 1.0f / 720.0f;
+	constexpr float exp_c5 = 1.0f / 120.0f;
+	constexpr float exp_c4 = 1.0f / 24.0f;
+	constexpr float exp_c3 = 1.0f / 6.0f;
+	constexpr float exp_c2 = 0.5f;
+
+	constexpr float ln2          = 0.693147182f;
+	constexpr float sqrt2        = 1.41421354f;
+	constexpr float min_normal   = 1.17549435e-38f;
+	constexpr float min_exponent = -126.0f;
+	constexpr float max_exponent = 127.0f;
+
+	/// Reference implementation, every SIMD path performs exactly the same float operations per lane
+	static float RemapAndPowScalar(float value, float power)
+	{
+		float x = (value + 1.0f) * 0.5f;
+		if (!(x >= min_normal))
+			return 0.0f;
+
+		/// log2(x) = exponent + log2(mantissa), mantissa moved to [sqrt(2) / 2, sqrt(2)]
+		uint32_t bits     = std::bit_cast<uint32_t>(x);
+		int      exponent = (int)((bits >> 23) & 0xff) - 127;
+		float    mantissa = std::bit_cast<float>((bits & 0x007fffff) | 0x3f800000);
+		if (mantissa > sqrt2)
+		{
+			mantissa = mantissa * 0.5f;
+			exponent = exponent + 1;
+		}
+
+		float t  = (mantissa - 1.0f) / (mantissa + 1.0f);
+		float t2 = t * t;
+		float p  = log2_c9;
+		p = p * t2 + log2_c7;
+		p = p * t2 + log2_c5;
+		p = p * t2 + log2_c3;
+		p = p * t2 + log2_c1;
+
+		float y = power * (p * t + (float)exponent);
+		y = std::min(std::max(y, min_exponent), max_exponent);
+
+		/// 2^y = 2^n * 2^f, n = floor(y + 0.5)
+		float r = y + 0.5f;
+		int   n = (int)r;
+		if ((float)n > r)
+			n = n - 1;
+
+		float g = (y - (float)n) * ln2;
+		float q = exp_c6;
+		q = q * g + exp_c5;
+		q = q * g + exp_c4;
+		q = q * g + exp_c3;
+		q = q * g + exp_c2;
+		q = q * g + 1.0f;
+		q = q * g + 1.0f;
+
+		return q * std::bit_cast<float>((uint32_t)(n + 127) << 23);
+	}
+
+#ifdef KC_NOISE_TRANSFORM_X86
+	static void RemapAndPowSSE2(float* values, size_t count, float power)
+	{
+		const __m128  one    = _mm_set1_ps(1.0f);
+		const __m128  half   = _mm_set1_ps(0.5f);
+		const __m128  powerV = _mm_set1_ps(power);
+		const __m128i one_i  = _mm_set1_epi32(1);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x     = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(values + i), one), half);
+			__m128 valid = _mm_cmpge_ps(x, _mm_set1_ps(min_normal));
+
+			__m128i bits     = _mm_castps_si128(x);
+			__m128i exponent = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)), _mm_set1_epi32(127));
+			__m128  mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+
+			__m128 large = _mm_cmpgt_ps(mantissa, _mm_set1_ps(sqrt2));
+			mantissa = _mm_or_ps(_mm_and_ps(large, _mm_mul_ps(mantissa, half)), _mm_andnot_ps(large, mantissa));
+			exponent = _mm_add_epi32(exponent, _mm_and_si128(_mm_castps_si128(large), one_i));
+
+			__m128 t  = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+			__m128 t2 = _mm_mul_ps(t, t);
+			__m128 p  = _mm_set1_ps(log2_c9);
+			p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(log2_c7));
+			p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(log2_c5));
+			p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(log2_c3));
+			p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(log2_c1));
+
+			__m128 y = _mm_mul_ps(powerV, _mm_add_ps(_mm_mul_ps(p, t), _mm_cvtepi32_ps(exponent)));
+			y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(min_exponent)), _mm_set1_ps(max_exponent));
+
+			__m128  r = _mm_add_ps(y, half);
+			__m128i n = _mm_cvttps_epi32(r);
+			n = _mm_sub_epi32(n, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(n), r)), one_i));
+
+			__m128 g = _mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(n)), _mm_set1_ps(ln2));
+			__m128 q = _mm_set1_ps(exp_c6);
+			q = _mm_add_ps(_mm_mul_ps(q, g), _mm_set1_ps(exp_c5));
+			q = _mm_add_ps(_mm_mul_ps(q, g), _mm_set1_ps(exp_c4));
+			q = _mm_add_ps(_mm_mul_ps(q, g), _mm_set1_ps(exp_c3));
+			q = _mm_add_ps(_mm_mul_ps(q, g), _mm_set1_ps(exp_c2));
+			q = _mm_add_ps(_mm_mul_ps(q, g), one);
+			q = _mm_add_ps(_mm_mul_ps(q, g), one);
+
+			__m128 scale  = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+			__m128 result = _mm_and_ps(valid, _mm_mul_ps(q, scale));
+			_mm_storeu_ps(values + i, result);
+		}
+
+		for (; i < count; i++)
+			values[i] = RemapAndPowScalar(values[i], power);
+	}
+
+	KC_TARGET_AVX2 static void RemapAndPowAVX2(float* values, size_t count, float power)
+	{
+		const __m256  one    = _mm256_set1_ps(1.0f);
+		const __m256  half   = _mm256_set1_ps(0.5f);
+		const __m256  powerV = _mm256_set1_ps(power);
+		const __m256i one_i  = _mm256_set1_epi32(1);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x     = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(values + i), one), half);
+			__m256 valid = _mm256_cmp_ps(x, _mm256_set1_ps(min_normal), _CMP_GE_OQ);
+
+			__m256i bits     = _mm256_castps_si256(x);
+			__m256i exponent = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff)), _mm256_set1_epi32(127));
+			__m256  mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+
+			__m256 large = _mm256_cmp_ps(mantissa, _mm256_set1_ps(sqrt2), _CMP_GT_OQ);
+			mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, half), large);
+			exponent = _mm256_add_epi32(exponent, _mm256_and_si256(_mm256_castps_si256(large), one_i));
+
+			__m256 t  = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+			__m256 t2 = _mm256_mul_ps(t, t);
+			__m256 p  = _mm256_set1_ps(log2_c9);
+			p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(log2_c7));
+			p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(log2_c5));
+			p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(log2_c3));
+			p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(log2_c1));
+
+			__m256 y = _mm256_mul_ps(powerV, _mm256_add_ps(_mm256_mul_ps(p, t), _mm256_cvtepi32_ps(exponent)));
+			y = _mm256_min_ps(_mm256_max_ps(y, _mm256_set1_ps(min_exponent)), _mm256_set1_ps(max_exponent));
+
+			__m256  r = _mm256_add_ps(y, half);
+			__m256i n = _mm256_cvttps_epi32(r);
+			n = _mm256_sub_epi32(n, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(n), r, _CMP_GT_OQ)), one_i));
+
+			__m256 g = _mm256_mul_ps(_mm256_sub_ps(y, _mm256_cvtepi32_ps(n)), _mm256_set1_ps(ln2));
+			__m256 q = _mm256_set1_ps(exp_c6);
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), _mm256_set1_ps(exp_c5));
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), _mm256_set1_ps(exp_c4));
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), _mm256_set1_ps(exp_c3));
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), _mm256_set1_ps(exp_c2));
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), one);
+			q = _mm256_add_ps(_mm256_mul_ps(q, g), one);
+
+			__m256 scale  = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+			__m256 result = _mm256_and_ps(valid, _mm256_mul_ps(q, scale));
+			_mm256_storeu_ps(values + i, result);
+		}
+
+		for (; i < count; i++)
+			values[i] = RemapAndPowScalar(values[i], power);
+	}
+#endif
+
+	void NoiseTransform::RemapAndPow(float* values, size_t count, float power)
+	{
+		/// pow(x, 1) is exact, the polynomial approximation would only add error
+		if (power == 1.0f)
+		{
+			for (size_t i = 0; i < count; i++)
+				values[i] = (values[i] + 1.0f) * 0.5f;
+			return;
+		}
+
+		if (!(power > 0.0f))
+		{
+			for (size_t i = 0; i < count; i++)
+				values[i] = std::pow((values[i] + 1.0f) * 0.5f, power);
+			return;
+		}
+
+		switch (GetInstructionSet())
+		{
+#ifdef KC_NOISE_TRANSFORM_X86
+			case InstructionSet::AVX2: RemapAndPowAVX2(values, count, power); return;
+			case InstructionSet::SSE2: RemapAndPowSSE2(values, count, power); return;
+#endif
+			default: break;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			values[i] = RemapAndPowScalar(values[i], power);
+	}
+
+	const char* NoiseTransform::GetInstructionSetName()
+	{
+		switch (GetInstructionSet())
+		{
+			case InstructionSet::AVX2: return "AVX2";
+			case InstructionSet::SSE2: return "SSE2";
+			default:                   return "Scalar";
+		}
+	}
+
+	NoiseTransform::InstructionSet NoiseTransform::GetInstructionSet()
+	{
+		/// FastNoiseSIMD already detects the CPU features: 3 and above support AVX2, 1 and above SSE2
+		static const InstructionSet instructionSet = []() {
+#ifdef KC_NOISE_TRANSFORM_X86
+			int level = FastNoiseSIMD::GetSIMDLevel();
+			if (level >= 3 && level != 5)
+				return InstructionSet::AVX2;
+			if (level >= 1 && level != 5)
+				return InstructionSet::SSE2;
+#endif
+			return InstructionSet::Scalar;
+		}();
+
+		return instructionSet;
+	}
+
+}
@@ -0,0 +1,40 @@
+///
+/// @file NoiseTransform.h
+///
+/// @author Michal Kuchnicki
+///
+/// @brief Header file containing the declaration of the NoiseTransform class, which applies
+///        the per sample post-processing of generator noises with SIMD instructions.
+///
+/// @details Raw noise in [-1, 1] is remapped to [0, 1] and raised to the noise power.
+///          The instruction set is chosen at runtime from the level FastNoiseSIMD detected: AVX2, SSE2,
+///          or plain C++ on other CPUs. The power is computed as exp2(power * log2(x)) with polynomials that
+///          every path evaluates with the same operations, so generated terrain does not depend on the CPU.
+///
+
+#pragma once
+
+namespace KuchCraft {
+
+	class NoiseTransform
+	{
+	public:
+		/// Remaps values from [-1, 1] to [0, 1] and raises them to a power, in place.
+		/// Values that end up at or below zero become zero.
+		/// @param values - the noise values.
+		/// @param count - the number of values.
+		/// @param power - the exponent, non-positive exponents fall back to std::pow.
+		static void RemapAndPow(float* values, size_t count, float power);
+
+		/// Retrieves the name of the instruction set used by RemapAndPow.
+		static const char* GetInstructionSetName();
+
+	private:
+		/// Instruction sets RemapAndPow can use
+		enum class InstructionSet : uint8_t { Scalar, SSE2, AVX2 };
+
+		/// Picks the instruction set on first use.
+		static InstructionSet GetInstructionSet();
+	};
+
+}
@@ -2,16 +2,40 @@
 
 #include <glm/glm.hpp>
 
+#include <array>
+
 namespace KuchCraft {
 
 	constexpr int max_spline_points = 20;
 
+	/// Number of equal cells [0, 1] is split into by the segment lookup table
+	constexpr int spline_lut_size = 256;
+
 	struct Spline
 	{
 		glm::vec2 Points[max_spline_points] = { { 0, 0 }, { 1, 1 } };
 		int Count = 2;
 
-		float Apply(float t)
+		/// First segment that can contain a value of every cell, so Apply only checks one or two segments
+		/// instead of scanning from the first point. A segment lower than the real one is always valid,
+		/// so the zeroed table of a spline that was not baked gives the same results, only slower.
+		std::array<uint8_t, spline_lut_size> SegmentLut = {};
+
+		/// Fills the segment lookup table, must be called after the points change
+		void Bake()
+		{
+			int i = 0;
+			for (int cell = 0; cell < spline_lut_size; cell++)
+			{
+				float t = (float)cell / spline_lut_size;
+				while (i + 2 < Count && Points[i + 1].x < t)
+					i++;
+
+				SegmentLut[cell] = (uint8_t)i;
+			}
+		}
+
+		float Apply(float t) const
 		{
 			if (t <= 0)
 				return Points[0].y;
@@ -19,7 +43,7 @@ namespace KuchCraft {
 			if (t >= 1)
 				return Points[Count - 1].y;
 
-			int i = 0;
+			int i = SegmentLut[(int)(t * spline_lut_size)];
 			while (Points[i + 1].x < t)
 				i++;
 
@@ -32,4 +56,4 @@ namespace KuchCraft {
 		}
 	};
 
-}
\ No newline at end of file
+}
@@ -3,8 +3,10 @@
 #include "World/Chunk/Chunk.h"
 #include "World/World/World.h"
 #include "World/Biome/BiomeMenager.h"
+#include "World/WorldGenerator/NoiseTransform.h"
 
 #include "Core/Config.h"
+#include "Core/ThreadPool.h"
 
 #include <imgui.h>
 #include <glad/glad.h>
@@ -13,12 +15,76 @@
 
 namespace KuchCraft {
 
+	/// Noise instances owned by the current thread
+	struct ThreadNoises
+	{
+		uint32_t Version = 0;
+		GeneratorNoises Noises;
+
+		~ThreadNoises() { Noises.Release(); }
+	};
+
+	static thread_local ThreadNoises t_Noises;
+
+	static thread_local GenerationContext t_Context;
+
+	/// Regions kept in the cache, enough for the generation area of a typical render distance
+	constexpr size_t region_cache_capacity = 64;
+
+	static_assert(std::tuple_size_v<GenerationContext::ColumnMap> == chunk_size_XZ * chunk_size_XZ, "Generation maps must cover a chunk");
+	static_assert(std::tuple_size_v<decltype(GenerationContext::SectionBlocks)> == chunk_section_block_count, "Section storage must cover a section");
+
+	void GeneratorNoises::Create(int seed)
+	{
+		auto setupNoise = [&](NoiseData& data, int seed) {
+			data.Noise = FastNoiseSIMD::NewFastNoiseSIMD();
+			data.Noise->SetSeed(seed);
+			data.Noise->SetNoiseType(static_cast<FastNoiseSIMD::NoiseType>(data.Type));
+			data.Noise->SetFrequency(data.Frequency);
+			data.Noise->SetFractalOctaves(data.Octaves);
+			data.Noise->SetCellularReturnType(static_cast<FastNoiseSIMD::CellularReturnType>(data.CellularReturnType));
+			data.Noise->SetPerturbFractalOctaves(data.PerturbFractalOctaves);
+		};
+
+		setupNoise(Continentalness,     seed + 0  );
+		setupNoise(Continentalness2,    seed + 33 );
+		setupNoise(ContinentalnessPick, seed + 43 );
+		setupNoise(PeaksAndValies,      seed + 53 );
+		setupNoise(PeaksAndValies2,     seed + 63 );
+		setupNoise(Temperature,         seed + 73 );
+		setupNoise(Humidity,            seed + 83 );
+		setupNoise(Vegetation,          seed + 93 );
+		setupNoise(Erosion,             seed + 103);
+	}
+
+	void GeneratorNoises::Release()
+	{
+		for (NoiseData* data : { &Continentalness, &Continentalness2, &ContinentalnessPick, &PeaksAndValies, &PeaksAndValies2,
+			&Temperature, &Humidity, &Vegetation, &Erosion })
+		{
+			delete data->Noise;
+			data->Noise = nullptr;
+		}
+	}
+
     void WorldGenerator::Reload(int seed)
     {
+		/// Settings are read by workers, they can not change while chunks are generated
+		ThreadPool::Wait();
+
 		Shutdown();
 
 		s_Seed = seed;
 
+		/// Threads recreate their noises on the next generated chunk
+		s_Version++;
+		s_RegionSize = (int)std::max(ApplicationConfig::GetWorldData().GeneratorRegionSize, 1u);
+
+		{
+			std::lock_guard lock(s_RegionsMutex);
+			s_Regions.clear();
+		}
+
 		std::ifstream file(ApplicationConfig::GetWorldData().WorldGeneratorPackFile);
 		if (!file.is_open())
 		{
@@ -76,156 +142,324 @@ namespace KuchCraft {
 					noiseData.Spline.Points[i].y = spline[i][1];
 				}
 				noiseData.Spline.Count = spline.size();
+				noiseData.Spline.Bake();
 			}
 
 			if (name == "ContinentalnessNoise")
-				s_ContinentalnessNoise = noiseData;
+				s_Noises.Continentalness = noiseData;
 			else if (name == "Continentalness2Noise")
-				s_Continentalness2Noise = noiseData;
+				s_Noises.Continentalness2 = noiseData;
 			else if (name == "ContinentalnessPick")
-				s_ContinentalnessPick = noiseData;
+				s_Noises.ContinentalnessPick = noiseData;
 			else if (name == "PeaksAndValiesNoise")
-				s_PeaksAndValiesNoise = noiseData;
+				s_Noises.PeaksAndValies = noiseData;
 			else if (name == "PeaksAndValies2Noise")
-				s_PeaksAndValies2Noise = noiseData;
+				s_Noises.PeaksAndValies2 = noiseData;
 			else if (name == "TemperatureNoise")
-				s_TemperatureNoise = noiseData;
+				s_Noises.Temperature = noiseData;
 			else if (name == "HumidityNoise")
-				s_HumidityNoise = noiseData;
+				s_Noises.Humidity = noiseData;
 			else if (name == "VegetationNoise")
-				s_VegetationNoise = noiseData;
+				s_Noises.Vegetation = noiseData;
 			else if (name == "ErosionNoise")
-				s_ErosionNoise = noiseData;
+				s_Noises.Erosion = noiseData;
 			else
 				Log::Error("[WorldGenerator] : Unknown noise name : {}", name);
 		}
+    }
 
-		auto setupNoise = [&](NoiseData& data, int seed) {
-            data.Noise = FastNoiseSIMD::NewFastNoiseSIMD();
-			data.Noise->SetSeed(seed);
-			data.Noise->SetNoiseType(static_cast<FastNoiseSIMD::NoiseType>(data.Type));
-			data.Noise->SetFrequency(data.Frequency);
-			data.Noise->SetFractalOctaves(data.Octaves);
-			data.Noise->SetCellularReturnType(static_cast<FastNoiseSIMD::CellularReturnType>(data.CellularReturnType));
-			data.Noise->SetPerturbFractalOctaves(data.PerturbFractalOctaves);
-		};
+    void WorldGenerator::Shutdown()
+    {
+		/// Worker threads release their own noises when they exit
+		t_Noises.Noises.Release();
+		t_Noises.Version = 0;
+    }
 
-		setupNoise(s_ContinentalnessNoise,  s_Seed + 0  );
-		setupNoise(s_Continentalness2Noise, s_Seed + 33 );
-		setupNoise(s_ContinentalnessPick,   s_Seed + 43 );
-		setupNoise(s_PeaksAndValiesNoise,   s_Seed + 53 );
-		setupNoise(s_PeaksAndValies2Noise,  s_Seed + 63 );
-		setupNoise(s_TemperatureNoise,      s_Seed + 73 );
-		setupNoise(s_HumidityNoise,         s_Seed + 83 );	
-		setupNoise(s_VegetationNoise,       s_Seed + 93 );
-		setupNoise(s_ErosionNoise,          s_Seed + 103);
+    GenerationContext& WorldGenerator::GetThreadContext()
+    {
+		return t_Context;
     }
 
-    void WorldGenerator::Shutdown()
+    GeneratorNoises& WorldGenerator::GetThreadNoises()
     {
-		delete s_ContinentalnessNoise .Noise;
-		delete s_Continentalness2Noise.Noise;
-		delete s_ContinentalnessPick  .Noise;
-		delete s_PeaksAndValiesNoise  .Noise;
-		delete s_PeaksAndValies2Noise .Noise;
-		delete s_TemperatureNoise     .Noise;
-		delete s_HumidityNoise        .Noise;
-		delete s_VegetationNoise      .Noise;
-		delete s_ErosionNoise         .Noise;
+		uint32_t version = s_Version.load(std::memory_order_acquire);
+		if (t_Noises.Version != version)
+		{
+			t_Noises.Noises.Release();
+			t_Noises.Noises = s_Noises;
+			t_Noises.Noises.Create(s_Seed);
+			t_Noises.Version = version;
+		}
+
+		return t_Noises.Noises;
     }
 
-    void WorldGenerator::GenerateChunk(Chunk* chunk)
+    std::shared_ptr<RegionNoiseMaps> WorldGenerator::GetRegion(const glm::ivec2& coord)
     {
-        if (!chunk) 
-            return;
+		std::shared_ptr<RegionNoiseMaps> region;
+		{
+			std::lock_guard lock(s_RegionsMutex);
 
-        glm::vec3 position = chunk->GetPosition();
+			uint32_t version = s_Version.load(std::memory_order_acquire);
+			auto it = std::find_if(s_Regions.begin(), s_Regions.end(), [&](const auto& cached) {
+				return cached->Coord == coord && cached->Version == version && cached->Size == s_RegionSize;
+			});
 
-		auto apply = [&](std::array<float, chunk_size_XZ * chunk_size_XZ>& tab, NoiseData& data) {
-			data.Noise->FillNoiseSet(tab.data(), (int)position.x, (int)position.y, (int)position.z, chunk_size_XZ, 1, chunk_size_XZ);
-			for (int i = 0; i < tab.size(); i++)
+			if (it != s_Regions.end())
 			{
-				tab[i] += 1;
-				tab[i] /= 2;
-				tab[i] = glm::pow(tab[i], data.Power);
-				tab[i] = data.Spline.Apply(tab[i]);
+				region = *it;
+				s_Regions.erase(it);
+				s_RegionHits++;
+			}
+			else
+			{
+				region = std::make_shared<RegionNoiseMaps>();
+				region->Coord   = coord;
+				region->Version = version;
+				region->Size    = s_RegionSize;
+				s_RegionMisses++;
+
+				if (s_Regions.size() >= region_cache_capacity)
+					s_Regions.pop_front();
 			}
+
+			s_Regions.push_back(region);
+		}
+
+		/// Generated outside of the lock, so threads working on other regions are not blocked
+		std::call_once(region->Generated, [&]() { GenerateRegion(*region); });
+
+		return region;
+    }
+
+    void WorldGenerator::GenerateRegion(RegionNoiseMaps& region)
+    {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		GeneratorNoises& noises = GetThreadNoises();
+
+		int side    = region.Size * chunk_size_XZ;
+		int columns = side * side;
+		int startX  = region.Coord.x * side;
+		int startZ  = region.Coord.y * side;
+
+		/// Noises only blended into the stored maps
+		static thread_local std::vector<float> continentalness2, continentalnessPick, peaksAndValies2;
+
+		std::chrono::nanoseconds postProcessTime{ 0 };
+
+		auto apply = [&](std::vector<float>& tab, NoiseData& data) {
+			tab.resize(columns);
+			data.Noise->FillNoiseSet(tab.data(), startX, 0, startZ, side, 1, side);
+
+			auto postProcessStart = std::chrono::high_resolution_clock::now();
+
+			NoiseTransform::RemapAndPow(tab.data(), tab.size(), data.Power);
+			for (int i = 0; i < columns; i++)
+				tab[i] = data.Spline.Apply(tab[i]);
+
+			postProcessTime += std::chrono::high_resolution_clock::now() - postProcessStart;
 		};
 
-		std::array<float, chunk_size_XZ* chunk_size_XZ> continentalness, continentalness2, continentalnessPick;
-		apply(continentalness,     s_ContinentalnessNoise);
-		apply(continentalness2,    s_Continentalness2Noise);
-		apply(continentalnessPick, s_ContinentalnessPick);
+		apply(region.Continentalness, noises.Continentalness);
+		apply(continentalness2,       noises.Continentalness2);
+		apply(continentalnessPick,    noises.ContinentalnessPick);
 
-		for (int i = 0; i < chunk->m_Continentalness.size(); i++)
-			chunk->m_Continentalness[i] = glm::mix(continentalness[i], continentalness2[i], continentalnessPick[i]);
+		for (int i = 0; i < columns; i++)
+			region.Continentalness[i] = glm::mix(region.Continentalness[i], continentalness2[i], continentalnessPick[i]);
 
-		std::array<float, chunk_size_XZ* chunk_size_XZ> peaksAndValies, peaksAndValies2;
-		apply(peaksAndValies,  s_PeaksAndValiesNoise);
-		apply(peaksAndValies2, s_PeaksAndValies2Noise);
+		apply(region.PeaksAndValies, noises.PeaksAndValies);
+		apply(peaksAndValies2,       noises.PeaksAndValies2);
 
-		for (int i = 0; i < chunk->m_PeaksAndValies.size(); i++)
-			chunk->m_PeaksAndValies[i] = glm::mix(peaksAndValies[i], peaksAndValies2[i], continentalnessPick[i]);
+		for (int i = 0; i < columns; i++)
+			region.PeaksAndValies[i] = glm::mix(region.PeaksAndValies[i], peaksAndValies2[i], continentalnessPick[i]);
 
-		apply(chunk->m_Temperature, s_TemperatureNoise);
-		apply(chunk->m_Humidity,    s_HumidityNoise);
-		apply(chunk->m_Vegetation,  s_VegetationNoise);
-		apply(chunk->m_Erosion,     s_ErosionNoise);
+		apply(region.Temperature, noises.Temperature);
+		apply(region.Humidity,    noises.Humidity);
+		apply(region.Vegetation,  noises.Vegetation);
+		apply(region.Erosion,     noises.Erosion);
 
-		const auto& biomes = BiomeMenager::Get();
+		auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+		s_NoiseTimeNs       += (uint64_t)time.count();
+		s_PostProcessTimeNs += (uint64_t)postProcessTime.count();
+		s_GeneratedColumns  += (uint64_t)columns;
+    }
+
+    void WorldGenerator::GenerateChunk(Chunk* chunk)
+    {
+        if (!chunk) 
+            return;
+
+		/// Without biomes no column can be filled, the chunk is left as air
+		glm::ivec2 chunkCoord = chunk->GetCoord();
+		if (BiomeMenager::Get().empty())
+		{
+			Log::Error("[WorldGenerator] : No biomes loaded, chunk ({}, {}) is left empty", chunkCoord.x, chunkCoord.y);
+			return;
+		}
+
+		GenerationContext& context = GetThreadContext();
+
+		/// Copy the columns of this chunk out of its region
+		auto floorDiv = [](int value, int divisor) { return value >= 0 ? value / divisor : (value - divisor + 1) / divisor; };
+		auto region   = GetRegion({ floorDiv(chunkCoord.x, s_RegionSize), floorDiv(chunkCoord.y, s_RegionSize) });
+
+		int side    = region->Size * chunk_size_XZ;
+		int offsetX = (chunkCoord.x - region->Coord.x * region->Size) * chunk_size_XZ;
+		int offsetZ = (chunkCoord.y - region->Coord.y * region->Size) * chunk_size_XZ;
+
+		auto slice = [&](GenerationContext::ColumnMap& tab, const std::vector<float>& map) {
+			for (int x = 0; x < chunk_size_XZ; x++)
+				std::copy_n(&map[(offsetX + x) * side + offsetZ], chunk_size_XZ, &tab[x * chunk_size_XZ]);
+		};
+
+		slice(context.Continentalness, region->Continentalness);
+		slice(context.PeaksAndValies,  region->PeaksAndValies);
+		slice(context.Temperature,     region->Temperature);
+		slice(context.Humidity,        region->Humidity);
+		slice(context.Vegetation,      region->Vegetation);
+		slice(context.Erosion,         region->Erosion);
+
+		ChunkClimateMap& climateMap = chunk->m_ClimateMap;
 
 		for (int x = 0; x < chunk_size_XZ; x++)
 		{
 			for (int z = 0; z < chunk_size_XZ; z++)
 			{
-				float temp = chunk->m_Temperature    [x * chunk_size_XZ + z];
-				float hum  = chunk->m_Humidity       [x * chunk_size_XZ + z];
-				float cont = chunk->m_Continentalness[x * chunk_size_XZ + z];
+				int   column = x * chunk_size_XZ + z;
+				float temp   = context.Temperature    [column];
+				float hum    = context.Humidity       [column];
+				float cont   = context.Continentalness[column];
+
+				const BiomeInfo* selectedBiome = BiomeMenager::Select(temp, hum, cont);
+
+				climateMap.BiomeIDs   [column] = (uint8_t)selectedBiome->ID;
+				climateMap.Temperature[column] = ChunkClimateMap::Quantize(temp);
+				climateMap.Humidity   [column] = ChunkClimateMap::Quantize(hum);
+				climateMap.Vegetation [column] = ChunkClimateMap::Quantize(context.Vegetation[column]);
+
+				int groundHeight = (int)glm::mix(0.8f, 1.2f, context.PeaksAndValies[column]);
+
+				/// Layers from the bottom: stone, gravel on eroded ground, 2 sub-surface blocks and the surface block
+				auto& runs     = context.ColumnRuns[column];
+				auto& runCount = context.ColumnRunCounts[column];
+				int   bottom   = 0;
+				runCount = 0;
+
+				auto addRun = [&](int top, const Item& block) {
+					top = std::min(top, chunk_size_Y - 1);
+					if (top < bottom)
+						return;
+
+					runs[runCount++] = { top, block };
+					bottom = top + 1;
+				};
+
+				bool eroded = context.Erosion[column] > 0.5f;
+				addRun(groundHeight - (eroded ? 6 : 3), Item(ItemData::Stone));
+				if (eroded)
+					addRun(groundHeight - 3, Item(ItemData::Gravel));
+				addRun(groundHeight - 1, Item(selectedBiome->Terrain.SubSurfaceBlock));
+				addRun(groundHeight,     Item(selectedBiome->Terrain.SurfaceBlock));
+			}
+		}
 
-				BiomeInfo* selectedBiome = nullptr;
-				float bestMatch = 1.0f;
+		WriteSections(chunk, context);
+    }
 
-				for (const auto& [name, curBiome] : biomes)
-				{
-					float tempDiff = glm::abs(temp - glm::mix(curBiome.Climate.MinTemperature,     curBiome.Climate.MaxTemperature,     0.5f));
-					float humDiff  = glm::abs(hum  - glm::mix(curBiome.Climate.MinHumidity,        curBiome.Climate.MaxHumidity,        0.5f));
-					float contDiff = glm::abs(cont - glm::mix(curBiome.Terrain.MinContinentalness, curBiome.Terrain.MaxContinentalness, 0.5f));
-					float biomeMatch = tempDiff + humDiff + contDiff;
+    void WorldGenerator::WriteSections(Chunk* chunk, GenerationContext& context)
+    {
+		const Item air(ItemData::Air);
 
-					if (biomeMatch < bestMatch)
-					{
-						bestMatch     = biomeMatch;
-						selectedBiome = const_cast<BiomeInfo*>(&curBiome);
-					}
-				}
+		/// Index of the run containing the current section bottom in every column, sections are visited bottom up
+		std::array<uint8_t, chunk_size_XZ * chunk_size_XZ> firstRuns = {};
+
+		for (int sectionIndex = 0; sectionIndex < chunk_section_count; sectionIndex++)
+		{
+			int sectionBottom = sectionIndex * chunk_section_size;
+			int sectionTop    = sectionBottom + chunk_section_size - 1;
 
-				if (!selectedBiome)
-					selectedBiome = const_cast<BiomeInfo*>(&biomes.begin()->second);
+			for (int column = 0; column < chunk_size_XZ * chunk_size_XZ; column++)
+			{
+				uint8_t& first = firstRuns[column];
+				while (first < context.ColumnRunCounts[column] && context.ColumnRuns[column][first].Top < sectionBottom)
+					first++;
+			}
 
-				chunk->m_BiomesIDs[x * chunk_size_XZ + z] = selectedBiome->ID;
+			/// A section is uniform if a single run of the same block covers it in every column
+			bool uniform = true;
+			Item uniformBlock = air;
+
+			for (int column = 0; column < chunk_size_XZ * chunk_size_XZ; column++)
+			{
+				uint8_t first = firstRuns[column];
 
-				int groundHeight = (int)glm::mix(0.8f, 1.2f, chunk->m_PeaksAndValies[x * chunk_size_XZ + z]);
+				bool inAir   = first == context.ColumnRunCounts[column];
+				Item block   = inAir ? air : context.ColumnRuns[column][first].Block;
+				bool covered = inAir || context.ColumnRuns[column][first].Top >= sectionTop;
 
-				for (int y = 0; y < chunk_size_Y; y++)
+				if (column == 0)
+					uniformBlock = block;
+
+				if (!covered || block != uniformBlock)
 				{
-					if (y > groundHeight)
-						chunk->m_Data[x][y][z] = Item(ItemData::Air);
-					else if (y == groundHeight)
-						chunk->m_Data[x][y][z] = Item(selectedBiome->Terrain.SurfaceBlock);
-					else if (y > groundHeight - 3)
-						chunk->m_Data[x][y][z] = Item(selectedBiome->Terrain.SubSurfaceBlock);
-					else if (y > groundHeight - 6 && chunk->m_Erosion[x * chunk_size_XZ + z] > 0.5f)
-						chunk->m_Data[x][y][z] = Item(ItemData::Gravel);
-					else
-						chunk->m_Data[x][y][z] = Item(ItemData::Stone);
+					uniform = false;
+					break;
 				}
 			}
-		}
 
+			auto& section = chunk->m_Sections[sectionIndex];
+			if (uniform)
+			{
+				if (uniformBlock != air)
+					section = std::make_shared<PalettedContainer>(chunk_section_block_count, uniformBlock);
+				continue;
+			}
+
+			/// Mixed sections are filled run by run and packed into the palette at once
+			for (int x = 0; x < chunk_size_XZ; x++)
+			{
+				for (int z = 0; z < chunk_size_XZ; z++)
+				{
+					int column = x * chunk_size_XZ + z;
+					int bottom = sectionBottom;
+
+					for (uint8_t run = firstRuns[column]; run < context.ColumnRunCounts[column] && bottom <= sectionTop; run++)
+					{
+						int top = std::min(context.ColumnRuns[column][run].Top, sectionTop);
+						for (int y = bottom; y <= top; y++)
+							context.SectionBlocks[Chunk::GetSectionBlockIndex({ x, y, z })] = context.ColumnRuns[column][run].Block;
+
+						bottom = top + 1;
+					}
+
+					for (int y = bottom; y <= sectionTop; y++)
+						context.SectionBlocks[Chunk::GetSectionBlockIndex({ x, y, z })] = air;
+				}
+			}
+
+			section = std::make_shared<PalettedContainer>(chunk_section_block_count, air);
+			section->Pack(context.SectionBlocks.data());
+		}
     }
     void WorldGenerator::OnImGuiRender()
     {
-        
+		uint64_t columns = s_GeneratedColumns.load();
+		uint64_t timeNs  = s_NoiseTimeNs.load();
+		uint64_t postNs  = s_PostProcessTimeNs.load();
+		uint64_t hits    = s_RegionHits.load();
+		uint64_t misses  = s_RegionMisses.load();
+
+		uint32_t cached = 0;
+		{
+			std::lock_guard lock(s_RegionsMutex);
+			cached = (uint32_t)s_Regions.size();
+		}
+
+		ImGui::Text("Noise region: %d x %d chunks, %u cached", s_RegionSize, s_RegionSize, cached);
+		ImGui::Text("Noise throughput: %.0f columns/s per thread", timeNs > 0 ? columns * 1e9 / (double)timeNs : 0.0);
+		ImGui::Text("Post-processing (%s): %.1f%% of region generation time", NoiseTransform::GetInstructionSetName(), timeNs > 0 ? postNs * 100.0 / (double)timeNs : 0.0);
+		ImGui::Text("Region cache hit rate: %.1f%%", hits + misses > 0 ? hits * 100.0 / (double)(hits + misses) : 0.0);
     }
 
 }
@@ -4,6 +4,8 @@
 
 #include "Spline.h"
 
+#include "World/Item/Item.h"
+
 namespace KuchCraft {
 
     class Chunk;
@@ -22,31 +24,135 @@ namespace KuchCraft {
         Spline Spline;
     };
 
+    /// Full set of noises used to generate terrain.
+    /// FastNoiseSIMD instances keep internal state and must not be shared between threads,
+    /// so every thread creates its own copy from the same settings.
+    struct GeneratorNoises
+    {
+        NoiseData Continentalness;
+        NoiseData Continentalness2;
+        NoiseData ContinentalnessPick;
+
+        NoiseData PeaksAndValies;
+        NoiseData PeaksAndValies2;
+
+        NoiseData Temperature;
+        NoiseData Humidity;
+        NoiseData Vegetation;
+        NoiseData Erosion;
+
+        /// Creates FastNoiseSIMD instances based on the stored settings.
+        /// @param seed - the world seed, every noise uses its own offset from it.
+        void Create(int seed);
+
+        /// Destroys FastNoiseSIMD instances, the settings are kept.
+        void Release();
+    };
+
+    /// Noise maps of a chunk used only while it is generated, the chunk keeps a quantized ChunkClimateMap.
+    struct GenerationContext
+    {
+        /// One value per chunk column, the size is checked against the chunk size in WorldGenerator.cpp
+        using ColumnMap = std::array<float, 16 * 16>;
+
+        ColumnMap Continentalness;
+        ColumnMap PeaksAndValies;
+        ColumnMap Temperature;
+        ColumnMap Humidity;
+        ColumnMap Vegetation;
+        ColumnMap Erosion;
+
+        /// Vertical run of a single block in a column, from the top of the previous run up to Top
+        struct BlockRun
+        {
+            int  Top;
+            Item Block;
+        };
+
+        /// Terrain layers of every column from the bottom up, everything above the last run is air
+        static constexpr int max_column_runs = 4;
+        std::array<std::array<BlockRun, max_column_runs>, 16 * 16> ColumnRuns;
+        std::array<uint8_t, 16 * 16> ColumnRunCounts;
+
+        /// Dense block storage of a single section, used for sections that are not uniform
+        std::array<Item, 16 * 16 * 16> SectionBlocks;
+    };
+
+    /// Noise maps of a square region of chunks, every noise is evaluated with a single FillNoiseSet call
+    /// for the whole region instead of one call per chunk. Maps use [x][z] column order of the region.
+    struct RegionNoiseMaps
+    {
+        /// Region coordinate, chunk coordinate divided by the region size rounded down
+        glm::ivec2 Coord = { 0, 0 };
+
+        /// Generator version and region size in chunks the maps were generated with
+        uint32_t Version = 0;
+        int      Size    = 0;
+
+        std::vector<float> Continentalness;
+        std::vector<float> PeaksAndValies;
+        std::vector<float> Temperature;
+        std::vector<float> Humidity;
+        std::vector<float> Vegetation;
+        std::vector<float> Erosion;
+
+        /// Maps are generated by the first thread that needs the region, other threads wait for it
+        std::once_flag Generated;
+    };
+
     class WorldGenerator
     {
     public:
+        /// Loads noise settings and seed. Waits for all running generation tasks to finish first.
         static void Reload(int seed);
 
 		static void Shutdown();
 
+        /// Fills chunk with blocks. Thread-safe, every calling thread uses its own noise instances,
+        /// so the result for a given seed does not depend on the thread it was generated on.
         static void GenerateChunk(Chunk* chunk);
 
         static void OnImGuiRender();
 
+    private:
+        /// Retrieves the generation context of the calling thread, reused for every chunk it generates.
+        static GenerationContext& GetThreadContext();
+
+        /// Writes the column runs of the context into the sections of a chunk, uniform sections are filled at once.
+        static void WriteSections(Chunk* chunk, GenerationContext& context);
+
+        /// Retrieves a region from the cache, creating it if needed, and generates its maps on first use.
+        /// @param coord - the region coordinate.
+        static std::shared_ptr<RegionNoiseMaps> GetRegion(const glm::ivec2& coord);
+
+        /// Evaluates every noise for the whole region.
+        static void GenerateRegion(RegionNoiseMaps& region);
+
+        /// Retrieves noises of the calling thread, recreating them if the settings changed since the last use.
+        static GeneratorNoises& GetThreadNoises();
+
     private:
         static inline int s_Seed = 1234;
 
-        static inline NoiseData s_ContinentalnessNoise;
-        static inline NoiseData s_Continentalness2Noise;
-        static inline NoiseData s_ContinentalnessPick;
+        /// Noise settings shared by all threads, instances are not created for them.
+        static inline GeneratorNoises s_Noises;
+
+        /// Incremented on every reload so threads know when to recreate their noises.
+        static inline std::atomic<uint32_t> s_Version = 0;
+
+        /// Number of chunks along a side of a noise region, set on reload.
+        static inline int s_RegionSize = 4;
 
-        static inline NoiseData s_PeaksAndValiesNoise;
-		static inline NoiseData s_PeaksAndValies2Noise;
+        /// Recently used regions, the most recent is at the back.
+        static inline std::deque<std::shared_ptr<RegionNoiseMaps>> s_Regions;
+        static inline std::mutex s_RegionsMutex;
 
-		static inline NoiseData s_TemperatureNoise;
-		static inline NoiseData s_HumidityNoise;
-		static inline NoiseData s_VegetationNoise;
-		static inline NoiseData s_ErosionNoise;
+        /// Generated columns and time spent evaluating and post-processing noises, summed over all threads.
+        static inline std::atomic<uint64_t> s_GeneratedColumns  = 0;
+        static inline std::atomic<uint64_t> s_NoiseTimeNs       = 0;
+        static inline std::atomic<uint64_t> s_PostProcessTimeNs = 0;
+        static inline std::atomic<uint64_t> s_RegionHits        = 0;
+        static inline std::atomic<uint64_t> s_RegionMisses      = 0;
     };
 
 }
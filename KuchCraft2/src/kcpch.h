@@ -23,7 +23,11 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
 #include <queue>
+#include <deque>
+#include <bit>
 
 #include <type_traits>
 #include <typeinfo>